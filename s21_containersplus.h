@@ -2,6 +2,10 @@
 #define S21_CONTAINERSPLUS_H
 
 #include "s21_lib/s21_array.h"
+#include "s21_lib/s21_concurrent_map.h"
+#include "s21_lib/s21_flat_map.h"
+#include "s21_lib/s21_flat_set.h"
 #include "s21_lib/s21_multiset.h"
+#include "s21_lib/s21_persistent_map.h"
 
 #endif
\ No newline at end of file
@@ -0,0 +1,1566 @@
+#ifndef S21_BTREE
+#define S21_BTREE
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../red_black_tree/rb_tree.h"
+
+namespace s21 {
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+class btree;
+
+// Политика B-дерева для set, multiset и map. node_slots - число элементов
+// в узле; 0 подбирает его так, чтобы лист занимал около 256 байт.
+// Вставка и удаление сдвигают элементы, итераторы не стабильны.
+template <size_t node_slots_ = 0>
+struct btree_options {
+  static constexpr bool order_statistics = false;
+  static constexpr bool stable_iterators = false;
+  static constexpr size_t node_slots = node_slots_;
+  template <typename data_type, typename compare, typename allocator,
+            typename options>
+  using backend = btree<data_type, compare, allocator, options>;
+};
+
+// B-дерево: элементы лежат во всех узлах отсортированными массивами, все
+// листья на одной глубине. Спуск проходит log_B n узлов вместо log_2 n, а
+// соседние элементы лежат рядом в памяти. Интерфейс тот же, что у rb_tree,
+// но вставка и удаление сдвигают элементы внутри узлов, поэтому делают
+// итераторы недействительными, а извлеченный элемент хранится
+// в дескрипторе по значению.
+template <typename data_type, typename compare = std::less<data_type>,
+          typename allocator = pool_allocator<data_type>,
+          typename options = btree_options<>>
+class btree {
+  static_assert(!options::order_statistics,
+                "btree: order statistics are not supported");
+
+ protected:
+  struct node;
+  struct internal_node;
+
+ public:
+  class iterator;
+  class const_iterator;
+  class node_handle;
+  struct insert_return_type;
+  using allocator_type = allocator;
+
+  btree() : btree(allocator_type()) {}
+  explicit btree(const allocator_type& alloc)
+      : leaf_alloc_(alloc), internal_alloc_(alloc) {}
+  btree(const btree& other);
+  btree(const btree& other, execution) : btree(other) {}
+  btree(btree&& other) noexcept;
+  btree(std::initializer_list<data_type> const& elem) : btree() {
+    assign_sorted(elem.begin(), elem.end());
+  }
+  template <typename input_iterator,
+            typename = typename std::iterator_traits<
+                input_iterator>::iterator_category>
+  btree(input_iterator first, input_iterator last) : btree() {
+    assign_sorted(first, last);
+  }
+  ~btree() { clear(); }
+
+  btree& operator=(btree&& other) noexcept;
+
+  iterator begin() { return iterator(leftmost(), 0, this); }
+  iterator end() { return iterator(nullptr, 0, this); }
+  iterator find(const data_type& value) { return find_by(value); }
+
+  const_iterator cbegin() const { return const_iterator(leftmost(), 0, this); }
+  const_iterator cend() const { return const_iterator(nullptr, 0, this); }
+  const_iterator find(const data_type& value) const { return find_by(value); }
+
+  // поиск по ключу без построения значения (для прозрачного компаратора)
+  template <typename key_type, typename key_compare = compare,
+            typename = std::enable_if_t<is_transparent<key_compare>::value>>
+  iterator find(const key_type& key) {
+    return find_by(key);
+  }
+  template <typename key_type, typename key_compare = compare,
+            typename = std::enable_if_t<is_transparent<key_compare>::value>>
+  const_iterator find(const key_type& key) const {
+    return find_by(key);
+  }
+
+  // как у rb_tree; узлы B-дерева широкие и неглубокие, ключи ищутся
+  // по очереди
+  template <typename key_iterator, typename output_iterator>
+  output_iterator find_many(key_iterator first, key_iterator last,
+                            output_iterator out) {
+    for (; first != last; ++first) *out++ = find_by(*first);
+    return out;
+  }
+  template <typename key_iterator, typename output_iterator>
+  output_iterator find_many(key_iterator first, key_iterator last,
+                            output_iterator out) const {
+    for (; first != last; ++first) *out++ = find_by(*first);
+    return out;
+  }
+
+  iterator lower_bound(const data_type& value) {
+    return lower_bound_by(value);
+  }
+  const_iterator lower_bound(const data_type& value) const {
+    return lower_bound_by(value);
+  }
+  iterator upper_bound(const data_type& value) {
+    return upper_bound_by(value);
+  }
+  const_iterator upper_bound(const data_type& value) const {
+    return upper_bound_by(value);
+  }
+  std::pair<iterator, iterator> equal_range(const data_type& value) {
+    return {lower_bound(value), upper_bound(value)};
+  }
+  std::pair<const_iterator, const_iterator> equal_range(
+      const data_type& value) const {
+    return {lower_bound(value), upper_bound(value)};
+  }
+
+  // наименьший и наибольший элементы, дерево не должно быть пустым
+  const data_type& front() const { return *leftmost()->value(0); }
+  const data_type& back() const {
+    const node* last = rightmost();
+    return *last->value(last->count_ - 1);
+  }
+
+  size_t size() const noexcept { return size_; }
+  size_t max_size() const noexcept {
+    return leaf_traits::max_size(leaf_alloc_);
+  }
+  bool empty() const noexcept { return size_ == 0; }
+  allocator_type get_allocator() const { return allocator_type(leaf_alloc_); }
+
+  void clear();
+  std::pair<iterator, bool> insert_data(const data_type& data);
+  template <typename... Args>
+  std::pair<iterator, bool> emplace_data(Args&&... args);
+  template <typename value_type>
+  iterator insert_hint(iterator hint, value_type&& data);
+  void erase(iterator pos);
+  iterator erase(iterator first, iterator last);
+  size_t erase(const data_type& value);
+  template <typename predicate>
+  size_t erase_if(predicate pred);
+  node_handle extract(iterator pos);
+  insert_return_type insert_handle(node_handle&& handle);
+  void swap(btree& other) noexcept;
+  void merge(btree& other);
+  template <typename input_iterator>
+  void assign_sorted(input_iterator first, input_iterator last);
+  // склейка с деревом right, все ключи которого не меньше pivot и ключей
+  // дерева; right остается пустым
+  void join(const data_type& pivot, btree& right);
+  void join(btree& right);
+  // теоретико-множественные операции как у rb_tree; режим выполнения
+  // принимается для совместимости, слияние идет в одном потоке
+  void assign_union(const btree& lhs, const btree& rhs,
+                    execution = execution::sequential) {
+    assign_set_operation(lhs, rhs, set_operation::unite);
+  }
+  void assign_intersection(const btree& lhs, const btree& rhs,
+                           execution = execution::sequential) {
+    assign_set_operation(lhs, rhs, set_operation::intersect);
+  }
+  void assign_difference(const btree& lhs, const btree& rhs,
+                         execution = execution::sequential) {
+    assign_set_operation(lhs, rhs, set_operation::subtract);
+  }
+  void assign_symmetric_difference(const btree& lhs, const btree& rhs,
+                                   execution = execution::sequential) {
+    assign_set_operation(lhs, rhs, set_operation::symmetric);
+  }
+  template <typename input_iterator>
+  void insert_sorted(input_iterator first, input_iterator last,
+                     execution = execution::sequential);
+
+  // все листья на одной глубине, узлы кроме корня заполнены не меньше
+  // чем наполовину
+  bool is_balanced() const;
+
+ protected:
+  static constexpr size_t target_node_bytes = 256;
+  static constexpr size_t slots =
+      options::node_slots != 0
+          ? options::node_slots
+          : std::max<size_t>(
+                3, (target_node_bytes - 2 * sizeof(void*)) / sizeof(data_type));
+  // деление полного узла оставляет в меньшей половине (slots - 1) / 2
+  static constexpr size_t min_count = (slots - 1) / 2;
+  static_assert(slots >= 3 && slots < 0xffff,
+                "btree: node_slots must be in [3, 65534]");
+
+  // Значения хранятся в сырой памяти узла и строятся по мере вставки
+  struct node {
+    internal_node* parent_ = nullptr;
+    unsigned short position_ = 0;
+    unsigned short count_ = 0;
+    bool leaf_ = true;
+    alignas(data_type) unsigned char storage_[slots * sizeof(data_type)];
+
+    data_type* slot(size_t index) noexcept {
+      return reinterpret_cast<data_type*>(storage_ + index * sizeof(data_type));
+    }
+    data_type* value(size_t index) noexcept {
+      return std::launder(slot(index));
+    }
+    const data_type* value(size_t index) const noexcept {
+      return std::launder(reinterpret_cast<const data_type*>(
+          storage_ + index * sizeof(data_type)));
+    }
+  };
+  struct internal_node : node {
+    node* children_[slots + 1] = {};
+    internal_node() { this->leaf_ = false; }
+  };
+
+  using leaf_allocator =
+      typename std::allocator_traits<allocator>::template rebind_alloc<node>;
+  using leaf_traits = std::allocator_traits<leaf_allocator>;
+  using internal_allocator = typename std::allocator_traits<
+      allocator>::template rebind_alloc<internal_node>;
+  using internal_traits = std::allocator_traits<internal_allocator>;
+
+  node* root_ = nullptr;
+  size_t size_ = 0;
+  compare compare_;
+  leaf_allocator leaf_alloc_;
+  internal_allocator internal_alloc_;
+
+  enum class set_operation { unite, intersect, subtract, symmetric };
+
+  template <typename value_type>
+  std::pair<iterator, bool> insert_unique(value_type&& data);
+  template <typename value_type>
+  iterator insert_equal(value_type&& data);
+  template <typename... Args>
+  iterator emplace_hint_data(iterator hint, Args&&... args) {
+    return insert_hint(hint, data_type(std::forward<Args>(args)...));
+  }
+  template <typename value_type>
+  iterator insert_leaf(node* leaf, size_t index, value_type&& data);
+  template <typename value_type>
+  void append(value_type&& data);
+  void append_tree(btree& right);
+  iterator erase_at(node* target, size_t index);
+  iterator rebalance(node* current, size_t index);
+  void split_node(node* full);
+  void merge_nodes(node* left);
+  void borrow_from_left(node* current);
+  void borrow_from_right(node* current);
+  virtual bool allows_duplicates() const noexcept { return false; }
+  bool in_order(const data_type& lhs, const data_type& rhs) const {
+    return allows_duplicates() ? !compare_(rhs, lhs) : compare_(lhs, rhs);
+  }
+
+  // поиск по ключу любого сравнимого с элементами типа
+  template <typename key_type>
+  iterator find_by(const key_type& key) {
+    std::pair<node*, size_t> found = find_position(key);
+    return iterator(found.first, found.second, this);
+  }
+  template <typename key_type>
+  const_iterator find_by(const key_type& key) const {
+    std::pair<node*, size_t> found = find_position(key);
+    return const_iterator(found.first, found.second, this);
+  }
+  template <typename key_type>
+  iterator lower_bound_by(const key_type& key) {
+    std::pair<node*, size_t> found = bound_position(key, false);
+    return iterator(found.first, found.second, this);
+  }
+  template <typename key_type>
+  const_iterator lower_bound_by(const key_type& key) const {
+    std::pair<node*, size_t> found = bound_position(key, false);
+    return const_iterator(found.first, found.second, this);
+  }
+  template <typename key_type>
+  iterator upper_bound_by(const key_type& key) {
+    std::pair<node*, size_t> found = bound_position(key, true);
+    return iterator(found.first, found.second, this);
+  }
+  template <typename key_type>
+  const_iterator upper_bound_by(const key_type& key) const {
+    std::pair<node*, size_t> found = bound_position(key, true);
+    return const_iterator(found.first, found.second, this);
+  }
+  template <typename key_type>
+  std::pair<node*, size_t> find_position(const key_type& key) const;
+  template <typename key_type>
+  std::pair<node*, size_t> bound_position(const key_type& key,
+                                          bool upper) const;
+  template <typename key_type>
+  size_t lower_index(const node* current, const key_type& key) const;
+  template <typename key_type>
+  size_t upper_index(const node* current, const key_type& key) const;
+  template <typename key_type>
+  void split_into(const key_type& key, btree& right);
+  void assign_set_operation(const btree& lhs, const btree& rhs,
+                            set_operation operation);
+  template <typename input_iterator>
+  bool is_sorted_range(input_iterator first, input_iterator last) const;
+  static bool prefers_rebuild(size_t batch, size_t total) noexcept;
+
+  // сборка дерева за O(n): next(узел, позиция) строит очередное значение
+  template <typename value_source>
+  void build_root(value_source& next, size_t count);
+  template <typename value_source>
+  node* build_subtree(value_source& next, size_t count, size_t level,
+                      const std::vector<size_t>& capacity);
+  void assign_moved(std::vector<data_type>& values);
+  node* copy_subtree(const node* source);
+  bool check_node(const node* current, size_t depth, size_t& leaf_depth,
+                  size_t& counted) const;
+
+  node* new_leaf();
+  internal_node* new_internal();
+  void free_node(node* current) noexcept;
+  void destroy_subtree(node* current) noexcept;
+  template <typename... Args>
+  void construct_value(node* target, size_t index, Args&&... args) {
+    leaf_traits::construct(leaf_alloc_, target->slot(index),
+                           std::forward<Args>(args)...);
+  }
+  void destroy_value(node* target, size_t index) noexcept {
+    leaf_traits::destroy(leaf_alloc_, target->value(index));
+  }
+  void move_value(node* from, size_t from_index, node* to, size_t to_index) {
+    construct_value(to, to_index, std::move(*from->value(from_index)));
+    destroy_value(from, from_index);
+  }
+  // сдвиг значений [index, count_) на одну позицию вправо и обратно
+  void open_slot(node* current, size_t index);
+  void close_slot(node* current, size_t index);
+
+  static internal_node* as_internal(node* current) noexcept {
+    return static_cast<internal_node*>(current);
+  }
+  static node*& child(node* current, size_t index) noexcept {
+    return as_internal(current)->children_[index];
+  }
+  static const node* child(const node* current, size_t index) noexcept {
+    return static_cast<const internal_node*>(current)->children_[index];
+  }
+  static void set_child(node* parent, size_t index, node* current) noexcept {
+    child(parent, index) = current;
+    current->parent_ = as_internal(parent);
+    current->position_ = static_cast<unsigned short>(index);
+  }
+  node* leftmost() const noexcept;
+  node* rightmost() const noexcept;
+  template <typename node_ptr>
+  static void next_position(node_ptr& current, size_t& index) noexcept;
+  template <typename node_ptr>
+  void prev_position(node_ptr& current, size_t& index) const noexcept;
+};
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+class btree<data_type, compare, allocator, options>::iterator {
+  friend class btree;
+
+ public:
+  iterator() : ptr_(nullptr), index_(0), tree_(nullptr) {}
+  iterator(node* ptr, size_t index, btree* tree)
+      : ptr_(ptr), index_(index), tree_(tree) {}
+
+  data_type& operator*() const { return *ptr_->value(index_); }
+  data_type* operator->() const { return ptr_->value(index_); }
+  iterator& operator++() {
+    next_position(ptr_, index_);
+    return *this;
+  }
+  iterator operator++(int) {
+    iterator copy = *this;
+    ++*this;
+    return copy;
+  }
+  iterator& operator--() {
+    tree_->prev_position(ptr_, index_);
+    return *this;
+  }
+  iterator operator--(int) {
+    iterator copy = *this;
+    --*this;
+    return copy;
+  }
+  bool operator==(const iterator& other) const {
+    return ptr_ == other.ptr_ && index_ == other.index_ &&
+           tree_ == other.tree_;
+  }
+  bool operator!=(const iterator& other) const { return !(*this == other); }
+
+ protected:
+  node* ptr_;
+  size_t index_;
+  btree* tree_;
+};
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+class btree<data_type, compare, allocator, options>::const_iterator {
+ public:
+  const_iterator() : ptr_(nullptr), index_(0), tree_(nullptr) {}
+  const_iterator(const node* ptr, size_t index, const btree* tree)
+      : ptr_(ptr), index_(index), tree_(tree) {}
+
+  const data_type& operator*() const { return *ptr_->value(index_); }
+  const data_type* operator->() const { return ptr_->value(index_); }
+  const_iterator& operator++() {
+    next_position(ptr_, index_);
+    return *this;
+  }
+  const_iterator operator++(int) {
+    const_iterator copy = *this;
+    ++*this;
+    return copy;
+  }
+  const_iterator& operator--() {
+    tree_->prev_position(ptr_, index_);
+    return *this;
+  }
+  const_iterator operator--(int) {
+    const_iterator copy = *this;
+    --*this;
+    return copy;
+  }
+  bool operator==(const const_iterator& other) const {
+    return ptr_ == other.ptr_ && index_ == other.index_ &&
+           tree_ == other.tree_;
+  }
+  bool operator!=(const const_iterator& other) const {
+    return !(*this == other);
+  }
+
+ protected:
+  const node* ptr_;
+  size_t index_;
+  const btree* tree_;
+};
+
+// Дескриптор извлеченного элемента: значение переезжает в него из узла
+// вместе с копией аллокатора дерева.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+class btree<data_type, compare, allocator, options>::node_handle {
+  friend class btree;
+
+ public:
+  node_handle() noexcept = default;
+  node_handle(node_handle&& other) noexcept
+      : value_(std::move(other.value_)), alloc_(std::move(other.alloc_)) {
+    other.reset();
+  }
+  node_handle& operator=(node_handle&& other) noexcept {
+    if (this != &other) {
+      value_ = std::move(other.value_);
+      alloc_ = std::move(other.alloc_);
+      other.reset();
+    }
+    return *this;
+  }
+
+  bool empty() const noexcept { return !value_.has_value(); }
+  explicit operator bool() const noexcept { return value_.has_value(); }
+  allocator_type get_allocator() const { return *alloc_; }
+
+  data_type& value() const { return *value_; }
+  // для map: ключ можно поменять до повторной вставки
+  template <typename value_type = data_type>
+  auto& key() const {
+    return value_->first;
+  }
+  template <typename value_type = data_type>
+  auto& mapped() const {
+    return value_->second;
+  }
+
+  void swap(node_handle& other) noexcept {
+    std::swap(value_, other.value_);
+    std::swap(alloc_, other.alloc_);
+  }
+
+ private:
+  node_handle(data_type&& data, const allocator_type& alloc)
+      : value_(std::move(data)), alloc_(alloc) {}
+
+  void reset() noexcept {
+    value_.reset();
+    alloc_.reset();
+  }
+
+  mutable std::optional<data_type> value_;
+  std::optional<allocator_type> alloc_;
+};
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+struct btree<data_type, compare, allocator, options>::insert_return_type {
+  iterator position;
+  bool inserted;
+  node_handle node;
+};
+
+template <typename data_type, typename compare, typename allocator,
+          typename options, typename predicate>
+size_t erase_if(btree<data_type, compare, allocator, options>& tree,
+                predicate pred) {
+  return tree.erase_if(pred);
+}
+}  // namespace s21
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+s21::btree<data_type, compare, allocator, options>::btree(const btree& other)
+    : btree(allocator_type(
+          leaf_traits::select_on_container_copy_construction(
+              other.leaf_alloc_))) {
+  compare_ = other.compare_;
+  if (other.size_ > 0) {
+    root_ = copy_subtree(other.root_);
+    size_ = other.size_;
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+s21::btree<data_type, compare, allocator, options>::btree(
+    btree&& other) noexcept
+    : root_(other.root_),
+      size_(other.size_),
+      compare_(std::move(other.compare_)),
+      leaf_alloc_(other.leaf_alloc_),
+      internal_alloc_(other.internal_alloc_) {
+  other.root_ = nullptr;
+  other.size_ = 0;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+s21::btree<data_type, compare, allocator, options>&
+s21::btree<data_type, compare, allocator, options>::operator=(
+    btree&& other) noexcept {
+  if (this != &other) {
+    clear();
+    root_ = other.root_;
+    size_ = other.size_;
+    compare_ = other.compare_;
+    leaf_alloc_ = other.leaf_alloc_;
+    internal_alloc_ = other.internal_alloc_;
+    other.root_ = nullptr;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::clear() {
+  if (root_) destroy_subtree(root_);
+  root_ = nullptr;
+  size_ = 0;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+std::pair<typename s21::btree<data_type, compare, allocator,
+                              options>::iterator, bool>
+s21::btree<data_type, compare, allocator, options>::insert_data(
+    const data_type& data) {
+  if (allows_duplicates()) return {insert_equal(data), true};
+  return insert_unique(data);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename... Args>
+std::pair<typename s21::btree<data_type, compare, allocator,
+                              options>::iterator, bool>
+s21::btree<data_type, compare, allocator, options>::emplace_data(
+    Args&&... args) {
+  data_type data(std::forward<Args>(args)...);
+  if (allows_duplicates()) return {insert_equal(std::move(data)), true};
+  return insert_unique(std::move(data));
+}
+
+// Новый элемент всегда встает в лист: перед первым не меньшим для
+// уникальных ключей и после последнего равного для дубликатов.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename value_type>
+std::pair<typename s21::btree<data_type, compare, allocator,
+                              options>::iterator, bool>
+s21::btree<data_type, compare, allocator, options>::insert_unique(
+    value_type&& data) {
+  if (!root_) root_ = new_leaf();
+  node* current = root_;
+  while (true) {
+    size_t index = lower_index(current, data);
+    if (index < current->count_ && !compare_(data, *current->value(index))) {
+      return std::make_pair(iterator(current, index, this), false);
+    }
+    if (current->leaf_) {
+      return std::make_pair(
+          insert_leaf(current, index, std::forward<value_type>(data)), true);
+    }
+    current = child(current, index);
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename value_type>
+typename s21::btree<data_type, compare, allocator, options>::iterator
+s21::btree<data_type, compare, allocator, options>::insert_equal(
+    value_type&& data) {
+  if (!root_) root_ = new_leaf();
+  node* current = root_;
+  while (!current->leaf_) current = child(current, upper_index(current, data));
+  return insert_leaf(current, upper_index(current, data),
+                     std::forward<value_type>(data));
+}
+
+// Если значение встает непосредственно перед hint, оно кладется в лист
+// рядом с hint без спуска от корня.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename value_type>
+typename s21::btree<data_type, compare, allocator, options>::iterator
+s21::btree<data_type, compare, allocator, options>::insert_hint(
+    iterator hint, value_type&& data) {
+  bool duplicates = allows_duplicates();
+  if (size_ > 0) {
+    iterator prev = hint;
+    bool has_prev = hint != begin();
+    if (has_prev) --prev;
+    bool before_next = hint == end() || (duplicates ? !compare_(*hint, data)
+                                                    : compare_(data, *hint));
+    bool after_prev = !has_prev || (duplicates ? !compare_(data, *prev)
+                                               : compare_(*prev, data));
+    if (before_next && after_prev) {
+      // перед элементом внутреннего узла или end() стоит конец листа
+      if (hint.ptr_ != nullptr && hint.ptr_->leaf_) {
+        return insert_leaf(hint.ptr_, hint.index_,
+                           std::forward<value_type>(data));
+      }
+      return insert_leaf(prev.ptr_, prev.index_ + 1,
+                         std::forward<value_type>(data));
+    }
+  }
+  if (duplicates) return insert_equal(std::forward<value_type>(data));
+  return insert_unique(std::forward<value_type>(data)).first;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename value_type>
+typename s21::btree<data_type, compare, allocator, options>::iterator
+s21::btree<data_type, compare, allocator, options>::insert_leaf(
+    node* leaf, size_t index, value_type&& data) {
+  if (leaf->count_ == slots) {
+    split_node(leaf);
+    if (index > leaf->count_) {
+      index -= leaf->count_ + 1;
+      leaf = child(leaf->parent_, leaf->position_ + 1);
+    }
+  }
+  open_slot(leaf, index);
+  try {
+    construct_value(leaf, index, std::forward<value_type>(data));
+  } catch (...) {
+    ++leaf->count_;
+    close_slot(leaf, index);
+    --leaf->count_;
+    throw;
+  }
+  ++leaf->count_;
+  ++size_;
+  return iterator(leaf, index, this);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename value_type>
+void s21::btree<data_type, compare, allocator, options>::append(
+    value_type&& data) {
+  if (!root_) root_ = new_leaf();
+  node* last = root_;
+  while (!last->leaf_) last = child(last, last->count_);
+  insert_leaf(last, last->count_, std::forward<value_type>(data));
+}
+
+// Небольшое дерево дописывается в конец по элементу, крупное - пересборкой
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::append_tree(
+    btree& right) {
+  if (prefers_rebuild(right.size_, size_ + right.size_)) {
+    std::vector<data_type> values;
+    values.reserve(size_ + right.size_);
+    for (iterator it = begin(); it != end(); ++it) {
+      values.push_back(std::move(*it));
+    }
+    for (iterator it = right.begin(); it != right.end(); ++it) {
+      values.push_back(std::move(*it));
+    }
+    assign_moved(values);
+  } else {
+    for (iterator it = right.begin(); it != right.end(); ++it) {
+      append(std::move(*it));
+    }
+  }
+  right.clear();
+}
+
+// Полный узел делится пополам, средний элемент поднимается в родителя.
+// Полный родитель делится раньше, полный корень дает новый уровень.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::split_node(
+    node* full) {
+  if (full == root_) {
+    internal_node* root = new_internal();
+    set_child(root, 0, full);
+    root_ = root;
+  } else if (full->parent_->count_ == slots) {
+    split_node(full->parent_);
+  }
+  node* parent = full->parent_;
+  node* sibling = full->leaf_ ? new_leaf() : new_internal();
+  size_t middle = full->count_ / 2;
+  for (size_t i = middle + 1; i < full->count_; ++i) {
+    move_value(full, i, sibling, i - middle - 1);
+  }
+  if (!full->leaf_) {
+    for (size_t i = middle + 1; i <= full->count_; ++i) {
+      set_child(sibling, i - middle - 1, child(full, i));
+    }
+  }
+  sibling->count_ = full->count_ - middle - 1;
+
+  size_t position = full->position_;
+  open_slot(parent, position);
+  for (size_t i = parent->count_ + 1; i > position + 1; --i) {
+    set_child(parent, i, child(parent, i - 1));
+  }
+  move_value(full, middle, parent, position);
+  set_child(parent, position + 1, sibling);
+  ++parent->count_;
+  full->count_ = middle;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::erase(iterator pos) {
+  if (pos.ptr_ == nullptr) return;
+  erase_at(pos.ptr_, pos.index_);
+}
+
+// Элемент внутреннего узла заменяется предшественником из листа, так что
+// удаляется всегда элемент листа. Возвращает позицию следующего элемента.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::btree<data_type, compare, allocator, options>::iterator
+s21::btree<data_type, compare, allocator, options>::erase_at(node* target,
+                                                             size_t index) {
+  bool internal = !target->leaf_;
+  node* leaf = target;
+  if (internal) {
+    leaf = child(target, index);
+    while (!leaf->leaf_) leaf = child(leaf, leaf->count_);
+    destroy_value(target, index);
+    move_value(leaf, leaf->count_ - 1, target, index);
+    index = leaf->count_ - 1;
+  } else {
+    destroy_value(leaf, index);
+  }
+  close_slot(leaf, index);
+  --leaf->count_;
+  --size_;
+  iterator next = rebalance(leaf, index);
+  // предшественник занял место удаленного, следующий идет за ним
+  if (internal) ++next;
+  return next;
+}
+
+// Недозаполненный узел занимает элемент у соседа через родителя или
+// сливается с ним; слияние может опустошить родителя, тогда подъем
+// продолжается. Позиция (current, index) отслеживается при переносах.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::btree<data_type, compare, allocator, options>::iterator
+s21::btree<data_type, compare, allocator, options>::rebalance(node* current,
+                                                              size_t index) {
+  node* tracked = current;
+  while (current != root_ && current->count_ < min_count) {
+    node* parent = current->parent_;
+    size_t position = current->position_;
+    node* left = position > 0 ? child(parent, position - 1) : nullptr;
+    node* right =
+        position < parent->count_ ? child(parent, position + 1) : nullptr;
+    if (left && left->count_ > min_count) {
+      borrow_from_left(current);
+      if (tracked == current) ++index;
+      break;
+    }
+    if (right && right->count_ > min_count) {
+      borrow_from_right(current);
+      break;
+    }
+    if (left) {
+      if (tracked == current) {
+        tracked = left;
+        index += left->count_ + 1;
+      }
+      merge_nodes(left);
+    } else {
+      merge_nodes(current);
+    }
+    current = parent;
+  }
+
+  if (root_->count_ == 0) {
+    if (root_->leaf_) {
+      free_node(root_);
+      root_ = nullptr;
+      return end();
+    }
+    node* old_root = root_;
+    root_ = child(old_root, 0);
+    root_->parent_ = nullptr;
+    root_->position_ = 0;
+    free_node(old_root);
+  }
+  while (tracked != nullptr && index == tracked->count_) {
+    index = tracked->position_;
+    tracked = tracked->parent_;
+  }
+  return iterator(tracked, index, this);
+}
+
+// left, разделитель и правый сосед left становятся одним узлом
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::merge_nodes(
+    node* left) {
+  node* parent = left->parent_;
+  size_t position = left->position_;
+  node* right = child(parent, position + 1);
+  size_t offset = left->count_ + 1;
+  move_value(parent, position, left, left->count_);
+  for (size_t i = 0; i < right->count_; ++i) {
+    move_value(right, i, left, offset + i);
+  }
+  if (!left->leaf_) {
+    for (size_t i = 0; i <= right->count_; ++i) {
+      set_child(left, offset + i, child(right, i));
+    }
+  }
+  left->count_ += right->count_ + 1;
+  right->count_ = 0;
+
+  close_slot(parent, position);
+  for (size_t i = position + 2; i <= parent->count_; ++i) {
+    set_child(parent, i - 1, child(parent, i));
+  }
+  --parent->count_;
+  free_node(right);
+}
+
+// Последний элемент левого соседа уходит в родителя, разделитель - в узел
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::borrow_from_left(
+    node* current) {
+  node* parent = current->parent_;
+  size_t position = current->position_;
+  node* left = child(parent, position - 1);
+  open_slot(current, 0);
+  move_value(parent, position - 1, current, 0);
+  move_value(left, left->count_ - 1, parent, position - 1);
+  if (!current->leaf_) {
+    for (size_t i = current->count_ + 1; i > 0; --i) {
+      set_child(current, i, child(current, i - 1));
+    }
+    set_child(current, 0, child(left, left->count_));
+  }
+  ++current->count_;
+  --left->count_;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::borrow_from_right(
+    node* current) {
+  node* parent = current->parent_;
+  size_t position = current->position_;
+  node* right = child(parent, position + 1);
+  move_value(parent, position, current, current->count_);
+  move_value(right, 0, parent, position);
+  if (!current->leaf_) {
+    set_child(current, current->count_ + 1, child(right, 0));
+    for (size_t i = 0; i < right->count_; ++i) {
+      set_child(right, i, child(right, i + 1));
+    }
+  }
+  close_slot(right, 0);
+  ++current->count_;
+  --right->count_;
+}
+
+// Небольшой диапазон удаляется поэлементно, большой - пересборкой дерева
+// из оставшихся элементов.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::btree<data_type, compare, allocator, options>::iterator
+s21::btree<data_type, compare, allocator, options>::erase(iterator first,
+                                                           iterator last) {
+  size_t count = 0;
+  for (iterator it = first; it != last; ++it) ++count;
+  if (count == 0) return last;
+  if (!prefers_rebuild(count, size_)) {
+    for (; count > 0; --count) first = erase_at(first.ptr_, first.index_);
+    return first;
+  }
+  size_t offset = 0;
+  for (iterator it = begin(); it != first; ++it) ++offset;
+  std::vector<data_type> kept;
+  kept.reserve(size_ - count);
+  size_t index = 0;
+  for (iterator it = begin(); it != end(); ++it, ++index) {
+    if (index < offset || index >= offset + count) {
+      kept.push_back(std::move(*it));
+    }
+  }
+  assign_moved(kept);
+  iterator next = begin();
+  for (; offset > 0; --offset) ++next;
+  return next;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+size_t s21::btree<data_type, compare, allocator, options>::erase(
+    const data_type& value) {
+  if (!allows_duplicates()) {
+    iterator found = find_by(value);
+    if (found == end()) return 0;
+    erase(found);
+    return 1;
+  }
+  std::pair<iterator, iterator> range = equal_range(value);
+  size_t count = 0;
+  for (iterator it = range.first; it != range.second; ++it) ++count;
+  erase(range.first, range.second);
+  return count;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename predicate>
+size_t s21::btree<data_type, compare, allocator, options>::erase_if(
+    predicate pred) {
+  std::vector<bool> removed;
+  removed.reserve(size_);
+  size_t count = 0;
+  for (const_iterator it = cbegin(); it != cend(); ++it) {
+    removed.push_back(pred(*it));
+    if (removed.back()) ++count;
+  }
+  if (count == 0) return 0;
+  if (!prefers_rebuild(count, size_)) {
+    iterator it = begin();
+    for (bool remove : removed) {
+      if (remove) {
+        it = erase_at(it.ptr_, it.index_);
+      } else {
+        ++it;
+      }
+    }
+  } else {
+    std::vector<data_type> kept;
+    kept.reserve(size_ - count);
+    size_t index = 0;
+    for (iterator it = begin(); it != end(); ++it, ++index) {
+      if (!removed[index]) kept.push_back(std::move(*it));
+    }
+    assign_moved(kept);
+  }
+  return count;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::btree<data_type, compare, allocator, options>::node_handle
+s21::btree<data_type, compare, allocator, options>::extract(iterator pos) {
+  if (pos.ptr_ == nullptr) return node_handle();
+  node_handle handle(std::move(*pos), get_allocator());
+  erase(pos);
+  return handle;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::btree<data_type, compare, allocator,
+                    options>::insert_return_type
+s21::btree<data_type, compare, allocator, options>::insert_handle(
+    node_handle&& handle) {
+  if (handle.empty()) return {end(), false, node_handle()};
+  std::pair<iterator, bool> result;
+  if (allows_duplicates()) {
+    result = {insert_equal(std::move(*handle.value_)), true};
+  } else {
+    result = insert_unique(std::move(*handle.value_));
+  }
+  if (!result.second) return {result.first, false, std::move(handle)};
+  handle.reset();
+  return {result.first, true, node_handle()};
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::swap(
+    btree& other) noexcept {
+  std::swap(root_, other.root_);
+  std::swap(size_, other.size_);
+  std::swap(compare_, other.compare_);
+  std::swap(leaf_alloc_, other.leaf_alloc_);
+  std::swap(internal_alloc_, other.internal_alloc_);
+}
+
+// Значения переезжают из other; уже имеющиеся ключи остаются в other.
+// Крупный other сливается с деревом за O(n + m) с пересборкой обоих.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::merge(btree& other) {
+  if (this == &other || other.empty()) return;
+  bool duplicates = allows_duplicates();
+  std::vector<data_type> rest;
+  if (!prefers_rebuild(other.size_, size_ + other.size_)) {
+    for (iterator it = other.begin(); it != other.end(); ++it) {
+      if (duplicates) {
+        insert_equal(std::move(*it));
+      } else if (!insert_unique(std::move(*it)).second) {
+        rest.push_back(std::move(*it));
+      }
+    }
+    other.assign_moved(rest);
+    return;
+  }
+  std::vector<data_type> merged;
+  merged.reserve(size_ + other.size_);
+  iterator left = begin();
+  iterator right = other.begin();
+  while (left != end() && right != other.end()) {
+    if (compare_(*right, *left)) {
+      merged.push_back(std::move(*right++));
+    } else if (!duplicates && !compare_(*left, *right)) {
+      merged.push_back(std::move(*left++));
+      rest.push_back(std::move(*right++));
+    } else {
+      merged.push_back(std::move(*left++));
+    }
+  }
+  for (; left != end(); ++left) merged.push_back(std::move(*left));
+  for (; right != other.end(); ++right) merged.push_back(std::move(*right));
+  assign_moved(merged);
+  other.assign_moved(rest);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::join(
+    const data_type& pivot, btree& right) {
+  if (this == &right || (!empty() && !in_order(back(), pivot)) ||
+      (!right.empty() && !in_order(pivot, right.front()))) {
+    throw std::invalid_argument("btree::join: keys are out of order");
+  }
+  append(pivot);
+  append_tree(right);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::join(btree& right) {
+  if (this == &right || right.empty()) return;
+  if (!empty() && !in_order(back(), right.front())) {
+    throw std::invalid_argument("btree::join: keys are out of order");
+  }
+  append_tree(right);
+}
+
+// Хвост от key переезжает в пустое дерево right, обе части собираются
+// заново за O(n)
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename key_type>
+void s21::btree<data_type, compare, allocator, options>::split_into(
+    const key_type& key, btree& right) {
+  iterator first = lower_bound_by(key);
+  if (first == end()) return;
+  std::vector<data_type> tail;
+  for (iterator it = first; it != end(); ++it) tail.push_back(std::move(*it));
+  erase(first, end());
+  right.assign_moved(tail);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::assign_set_operation(
+    const btree& lhs, const btree& rhs, set_operation operation) {
+  bool keep_left = operation != set_operation::intersect;
+  bool keep_right = operation == set_operation::unite ||
+                    operation == set_operation::symmetric;
+  bool keep_common = operation == set_operation::unite ||
+                     operation == set_operation::intersect;
+  std::vector<data_type> result;
+  const_iterator left = lhs.cbegin();
+  const_iterator right = rhs.cbegin();
+  while (left != lhs.cend() && right != rhs.cend()) {
+    if (compare_(*left, *right)) {
+      if (keep_left) result.push_back(*left);
+      ++left;
+    } else if (compare_(*right, *left)) {
+      if (keep_right) result.push_back(*right);
+      ++right;
+    } else {
+      if (keep_common) result.push_back(*left);
+      ++left;
+      ++right;
+    }
+  }
+  for (; keep_left && left != lhs.cend(); ++left) result.push_back(*left);
+  for (; keep_right && right != rhs.cend(); ++right) result.push_back(*right);
+  assign_moved(result);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename input_iterator>
+void s21::btree<data_type, compare, allocator, options>::insert_sorted(
+    input_iterator first, input_iterator last, execution) {
+  using category =
+      typename std::iterator_traits<input_iterator>::iterator_category;
+  if constexpr (!std::is_base_of_v<std::random_access_iterator_tag,
+                                   category>) {
+    std::vector<data_type> buffer(first, last);
+    insert_sorted(buffer.cbegin(), buffer.cend());
+  } else {
+    size_t count = last - first;
+    if (!std::is_sorted(first, last, compare_) ||
+        !prefers_rebuild(count, size_ + count)) {
+      for (; first != last; ++first) insert_data(*first);
+      return;
+    }
+    bool duplicates = allows_duplicates();
+    std::vector<data_type> merged;
+    merged.reserve(size_ + count);
+    iterator it = begin();
+    for (; first != last; ++first) {
+      while (it != end() && !compare_(*first, *it)) {
+        merged.push_back(std::move(*it++));
+      }
+      if (duplicates || merged.empty() || compare_(merged.back(), *first)) {
+        merged.push_back(*first);
+      }
+    }
+    for (; it != end(); ++it) merged.push_back(std::move(*it));
+    assign_moved(merged);
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename input_iterator>
+void s21::btree<data_type, compare, allocator, options>::assign_sorted(
+    input_iterator first, input_iterator last) {
+  using category =
+      typename std::iterator_traits<input_iterator>::iterator_category;
+  if constexpr (!std::is_base_of_v<std::forward_iterator_tag, category>) {
+    std::vector<data_type> buffer(first, last);
+    assign_sorted(buffer.cbegin(), buffer.cend());
+  } else {
+    clear();
+    if (is_sorted_range(first, last)) {
+      size_t count = std::distance(first, last);
+      auto next = [this, &first](node* target, size_t index) {
+        construct_value(target, index, *first);
+        ++first;
+      };
+      build_root(next, count);
+    } else {
+      for (; first != last; ++first) {
+        insert_data(*first);
+      }
+    }
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename input_iterator>
+bool s21::btree<data_type, compare, allocator, options>::is_sorted_range(
+    input_iterator first, input_iterator last) const {
+  if (first == last) return true;
+  for (input_iterator next = std::next(first); next != last; ++first, ++next) {
+    if (!in_order(*first, *next)) return false;
+  }
+  return true;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+bool s21::btree<data_type, compare, allocator, options>::prefers_rebuild(
+    size_t batch, size_t total) noexcept {
+  size_t height = 1;
+  while ((size_t(1) << height) < total) ++height;
+  return batch * height >= total;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::assign_moved(
+    std::vector<data_type>& values) {
+  clear();
+  auto it = values.begin();
+  auto next = [this, &it](node* target, size_t index) {
+    construct_value(target, index, std::move(*it));
+    ++it;
+  };
+  build_root(next, values.size());
+}
+
+// capacity[h] - наибольшее число элементов в дереве высоты h + 1.
+// Берется наименьшая подходящая высота, элементы делятся между
+// наименьшим возможным числом детей поровну, так что узлы заполнены
+// плотно и не меньше чем наполовину.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename value_source>
+void s21::btree<data_type, compare, allocator, options>::build_root(
+    value_source& next, size_t count) {
+  std::vector<size_t> capacity{slots};
+  while (capacity.back() < count) {
+    capacity.push_back((capacity.back() + 1) * (slots + 1) - 1);
+  }
+  if (count > 0) {
+    root_ = build_subtree(next, count, capacity.size() - 1, capacity);
+  }
+  size_ = count;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename value_source>
+typename s21::btree<data_type, compare, allocator, options>::node*
+s21::btree<data_type, compare, allocator, options>::build_subtree(
+    value_source& next, size_t count, size_t level,
+    const std::vector<size_t>& capacity) {
+  node* current = level == 0 ? new_leaf() : new_internal();
+  try {
+    if (level == 0) {
+      while (current->count_ < count) {
+        next(current, current->count_);
+        ++current->count_;
+      }
+    } else {
+      size_t child_capacity = capacity[level - 1];
+      size_t children = (count + child_capacity + 1) / (child_capacity + 1);
+      size_t spread = count - (children - 1);
+      for (size_t i = 0; i < children; ++i) {
+        size_t part = spread / children + (i < spread % children ? 1 : 0);
+        set_child(current, i,
+                  build_subtree(next, part, level - 1, capacity));
+        if (i + 1 < children) {
+          next(current, i);
+          ++current->count_;
+        }
+      }
+    }
+  } catch (...) {
+    destroy_subtree(current);
+    throw;
+  }
+  return current;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::btree<data_type, compare, allocator, options>::node*
+s21::btree<data_type, compare, allocator, options>::copy_subtree(
+    const node* source) {
+  node* target = source->leaf_ ? new_leaf() : new_internal();
+  try {
+    while (target->count_ < source->count_) {
+      construct_value(target, target->count_,
+                      *source->value(target->count_));
+      ++target->count_;
+    }
+    if (!source->leaf_) {
+      for (size_t i = 0; i <= source->count_; ++i) {
+        set_child(target, i, copy_subtree(child(source, i)));
+      }
+    }
+  } catch (...) {
+    destroy_subtree(target);
+    throw;
+  }
+  return target;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+bool s21::btree<data_type, compare, allocator, options>::is_balanced() const {
+  if (!root_) return size_ == 0;
+  size_t leaf_depth = 0;
+  size_t counted = 0;
+  return check_node(root_, 1, leaf_depth, counted) && counted == size_;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+bool s21::btree<data_type, compare, allocator, options>::check_node(
+    const node* current, size_t depth, size_t& leaf_depth,
+    size_t& counted) const {
+  if (current->count_ > slots ||
+      (current != root_ && current->count_ < min_count)) {
+    return false;
+  }
+  for (size_t i = 1; i < current->count_; ++i) {
+    if (!in_order(*current->value(i - 1), *current->value(i))) return false;
+  }
+  counted += current->count_;
+  if (current->leaf_) {
+    if (leaf_depth == 0) leaf_depth = depth;
+    return leaf_depth == depth;
+  }
+  for (size_t i = 0; i <= current->count_; ++i) {
+    const node* next = child(current, i);
+    if (next->parent_ != current || next->position_ != i ||
+        !check_node(next, depth + 1, leaf_depth, counted)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename key_type>
+std::pair<typename s21::btree<data_type, compare, allocator, options>::node*,
+          size_t>
+s21::btree<data_type, compare, allocator, options>::find_position(
+    const key_type& key) const {
+  std::pair<node*, size_t> found = bound_position(key, false);
+  if (found.first && compare_(key, *found.first->value(found.second))) {
+    return {nullptr, 0};
+  }
+  return found;
+}
+
+// Последний встреченный на спуске подходящий элемент и есть граница:
+// элементы глубже лежат левее него.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename key_type>
+std::pair<typename s21::btree<data_type, compare, allocator, options>::node*,
+          size_t>
+s21::btree<data_type, compare, allocator, options>::bound_position(
+    const key_type& key, bool upper) const {
+  std::pair<node*, size_t> result(nullptr, 0);
+  node* current = size_ > 0 ? root_ : nullptr;
+  while (current != nullptr) {
+    size_t index =
+        upper ? upper_index(current, key) : lower_index(current, key);
+    if (index < current->count_) result = {current, index};
+    if (current->leaf_) break;
+    current = child(current, index);
+  }
+  return result;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename key_type>
+size_t s21::btree<data_type, compare, allocator, options>::lower_index(
+    const node* current, const key_type& key) const {
+  size_t first = 0;
+  size_t count = current->count_;
+  while (count > 0) {
+    size_t half = count / 2;
+    if (compare_(*current->value(first + half), key)) {
+      first += half + 1;
+      count -= half + 1;
+    } else {
+      count = half;
+    }
+  }
+  return first;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename key_type>
+size_t s21::btree<data_type, compare, allocator, options>::upper_index(
+    const node* current, const key_type& key) const {
+  size_t first = 0;
+  size_t count = current->count_;
+  while (count > 0) {
+    size_t half = count / 2;
+    if (!compare_(key, *current->value(first + half))) {
+      first += half + 1;
+      count -= half + 1;
+    } else {
+      count = half;
+    }
+  }
+  return first;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::btree<data_type, compare, allocator, options>::node*
+s21::btree<data_type, compare, allocator, options>::new_leaf() {
+  node* leaf = leaf_traits::allocate(leaf_alloc_, 1);
+  leaf_traits::construct(leaf_alloc_, leaf);
+  return leaf;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::btree<data_type, compare, allocator, options>::internal_node*
+s21::btree<data_type, compare, allocator, options>::new_internal() {
+  internal_node* internal = internal_traits::allocate(internal_alloc_, 1);
+  internal_traits::construct(internal_alloc_, internal);
+  return internal;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::free_node(
+    node* current) noexcept {
+  if (current->leaf_) {
+    leaf_traits::destroy(leaf_alloc_, current);
+    leaf_traits::deallocate(leaf_alloc_, current, 1);
+  } else {
+    internal_node* internal = as_internal(current);
+    internal_traits::destroy(internal_alloc_, internal);
+    internal_traits::deallocate(internal_alloc_, internal, 1);
+  }
+}
+
+// Недостроенный узел тоже разбирается: его count_ учитывает только
+// построенные значения, а отсутствующие дети равны nullptr.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::destroy_subtree(
+    node* current) noexcept {
+  if (!current->leaf_) {
+    for (size_t i = 0; i <= current->count_; ++i) {
+      if (child(current, i)) destroy_subtree(child(current, i));
+    }
+  }
+  for (size_t i = 0; i < current->count_; ++i) destroy_value(current, i);
+  free_node(current);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::open_slot(
+    node* current, size_t index) {
+  for (size_t i = current->count_; i > index; --i) {
+    move_value(current, i - 1, current, i);
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::btree<data_type, compare, allocator, options>::close_slot(
+    node* current, size_t index) {
+  for (size_t i = index + 1; i < current->count_; ++i) {
+    move_value(current, i, current, i - 1);
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::btree<data_type, compare, allocator, options>::node*
+s21::btree<data_type, compare, allocator, options>::leftmost() const noexcept {
+  if (size_ == 0) return nullptr;
+  node* current = root_;
+  while (!current->leaf_) current = child(current, 0);
+  return current;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::btree<data_type, compare, allocator, options>::node*
+s21::btree<data_type, compare, allocator, options>::rightmost()
+    const noexcept {
+  if (size_ == 0) return nullptr;
+  node* current = root_;
+  while (!current->leaf_) current = child(current, current->count_);
+  return current;
+}
+
+// После элемента внутреннего узла идет начало правого поддерева, после
+// конца листа - разделитель у ближайшего предка справа.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename node_ptr>
+void s21::btree<data_type, compare, allocator, options>::next_position(
+    node_ptr& current, size_t& index) noexcept {
+  if (!current->leaf_) {
+    current = child(current, index + 1);
+    while (!current->leaf_) current = child(current, 0);
+    index = 0;
+    return;
+  }
+  ++index;
+  while (index == current->count_) {
+    if (current->parent_ == nullptr) {
+      current = nullptr;
+      index = 0;
+      return;
+    }
+    index = current->position_;
+    current = current->parent_;
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename node_ptr>
+void s21::btree<data_type, compare, allocator, options>::prev_position(
+    node_ptr& current, size_t& index) const noexcept {
+  if (current == nullptr || !current->leaf_) {
+    current = current == nullptr ? root_ : child(current, index);
+    while (!current->leaf_) current = child(current, current->count_);
+    index = current->count_ - 1;
+    return;
+  }
+  if (index > 0) {
+    --index;
+    return;
+  }
+  while (current->parent_ != nullptr && current->position_ == 0) {
+    current = current->parent_;
+  }
+  index = current->position_ - 1;
+  current = current->parent_;
+}
+
+#endif
@@ -0,0 +1,244 @@
+#ifndef S21_EYTZINGER_TREE
+#define S21_EYTZINGER_TREE
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <vector>
+
+#include "../red_black_tree/rb_tree.h"
+
+namespace s21 {
+// Выделяет массивы так, что перед первым элементом остается место ровно
+// под один элемент, а начало этого места выровнено на строку кэша: тогда
+// элемент с номером k (с единицы) лежит на смещении k * sizeof(T) от
+// границы строки.
+template <typename T>
+class line_offset_allocator {
+ public:
+  using value_type = T;
+
+  line_offset_allocator() = default;
+  template <typename U>
+  line_offset_allocator(const line_offset_allocator<U>&) noexcept {}
+
+  T* allocate(size_t n) {
+    char* line = static_cast<char*>(
+        ::operator new((n + 1) * sizeof(T), std::align_val_t(line_size)));
+    return reinterpret_cast<T*>(line + sizeof(T));
+  }
+  void deallocate(T* ptr, size_t) noexcept {
+    ::operator delete(reinterpret_cast<char*>(ptr) - sizeof(T),
+                      std::align_val_t(line_size));
+  }
+
+  template <typename U>
+  bool operator==(const line_offset_allocator<U>&) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const line_offset_allocator<U>&) const noexcept {
+    return false;
+  }
+
+ private:
+  static constexpr size_t line_size = 64;
+};
+
+// Неизменяемое дерево поиска в раскладке Эйтцингера: элементы лежат в
+// массиве в порядке обхода в ширину, потомки узла k (с единицы) - 2k и
+// 2k + 1. Спуск идет без ветвлений, а первые уровни дерева всегда в кэше.
+template <typename data_type, typename compare = std::less<data_type>>
+class eytzinger_tree {
+ public:
+  class const_iterator;
+  using iterator = const_iterator;
+
+  eytzinger_tree() = default;
+  // [first, last) - count элементов, отсортированных по compare без
+  // повторов
+  template <typename input_iterator>
+  eytzinger_tree(input_iterator first, input_iterator last, size_t count);
+
+  const_iterator begin() const;
+  const_iterator end() const { return const_iterator(this, 0); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  bool empty() const noexcept { return data_.empty(); }
+  size_t size() const noexcept { return data_.size(); }
+
+  const_iterator find(const data_type& value) const { return find_by(value); }
+  const_iterator lower_bound(const data_type& value) const {
+    return const_iterator(this, lower_index(value));
+  }
+  const_iterator upper_bound(const data_type& value) const {
+    return const_iterator(this, upper_index(value));
+  }
+  bool contains(const data_type& value) const {
+    return find(value) != end();
+  }
+
+ protected:
+  compare compare_;
+  // data_[k - 1] - узел k; потомки узла через несколько уровней занимают
+  // целую строку кэша, если sizeof(data_type) делит 64
+  std::vector<data_type, line_offset_allocator<data_type>> data_;
+
+  template <typename key_type>
+  const_iterator find_by(const key_type& key) const;
+  template <typename key_type>
+  size_t lower_index(const key_type& key) const;
+  template <typename key_type>
+  size_t upper_index(const key_type& key) const;
+
+ private:
+  // на сколько уровней вперед загружается спуск: столько элементов,
+  // сколько помещается в строку кэша, - это потомки узла через
+  // log2(line_elements) уровней
+  static constexpr size_t line_elements =
+      sizeof(data_type) >= 64 ? 1 : 64 / sizeof(data_type);
+
+  void prefetch_descendants(size_t index) const noexcept {
+    // адрес считается в целых: указатель за концом массива не строится
+    prefetch_line(reinterpret_cast<const void*>(
+        reinterpret_cast<uintptr_t>(data_.data()) +
+        (index * line_elements - 1) * sizeof(data_type)));
+  }
+  // отбрасывает шаги вправо после последнего шага влево: остается узел,
+  // где спуск последний раз ушел влево, или 0
+  static size_t last_left_turn(size_t index) noexcept {
+    while (index & 1) index >>= 1;
+    return index >> 1;
+  }
+  // первая и следующая позиции симметричного обхода
+  static size_t first_index(size_t size) noexcept {
+    if (size == 0) return 0;
+    size_t index = 1;
+    while (2 * index <= size) index *= 2;
+    return index;
+  }
+  static size_t next_index(size_t index, size_t size) noexcept {
+    if (2 * index + 1 > size) return last_left_turn(index);
+    index = 2 * index + 1;
+    while (2 * index <= size) index *= 2;
+    return index;
+  }
+};
+
+// Позиция с единицы в массиве, 0 - конец
+template <typename data_type, typename compare>
+class eytzinger_tree<data_type, compare>::const_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = data_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const data_type*;
+  using reference = const data_type&;
+
+  const_iterator() : tree_(nullptr), index_(0) {}
+  const_iterator(const eytzinger_tree* tree, size_t index)
+      : tree_(tree), index_(index) {}
+
+  reference operator*() const { return tree_->data_[index_ - 1]; }
+  pointer operator->() const { return &tree_->data_[index_ - 1]; }
+  const_iterator& operator++();
+  const_iterator operator++(int);
+  bool operator==(const const_iterator& other) const {
+    return index_ == other.index_ && tree_ == other.tree_;
+  }
+  bool operator!=(const const_iterator& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  const eytzinger_tree* tree_;
+  size_t index_;
+};
+}  // namespace s21
+
+// Позиции в порядке обхода в ширину получают ранги симметричным обходом
+// неявного дерева; сами элементы копируются один раз.
+template <typename data_type, typename compare>
+template <typename input_iterator>
+s21::eytzinger_tree<data_type, compare>::eytzinger_tree(input_iterator first,
+                                                        input_iterator last,
+                                                        size_t count) {
+  std::vector<const data_type*> sorted;
+  sorted.reserve(count);
+  for (; first != last; ++first) {
+    sorted.push_back(&*first);
+  }
+  size_t size = sorted.size();
+  std::vector<size_t> rank(size + 1);
+  size_t index = first_index(size);
+  for (size_t next_rank = 0; next_rank < size; ++next_rank) {
+    rank[index] = next_rank;
+    index = next_index(index, size);
+  }
+  data_.reserve(size);
+  for (index = 1; index <= size; ++index) {
+    data_.push_back(*sorted[rank[index]]);
+  }
+}
+
+template <typename data_type, typename compare>
+typename s21::eytzinger_tree<data_type, compare>::const_iterator
+s21::eytzinger_tree<data_type, compare>::begin() const {
+  return const_iterator(this, first_index(size()));
+}
+
+// Спуск идет до листа: шаг - выбор потомка по результату сравнения, без
+// условного перехода. Нижняя граница - узел, где спуск последний раз
+// повернул влево.
+template <typename data_type, typename compare>
+template <typename key_type>
+size_t s21::eytzinger_tree<data_type, compare>::lower_index(
+    const key_type& key) const {
+  size_t index = 1;
+  while (index <= size()) {
+    prefetch_descendants(index);
+    index = 2 * index + compare_(data_[index - 1], key);
+  }
+  return last_left_turn(index);
+}
+
+template <typename data_type, typename compare>
+template <typename key_type>
+size_t s21::eytzinger_tree<data_type, compare>::upper_index(
+    const key_type& key) const {
+  size_t index = 1;
+  while (index <= size()) {
+    prefetch_descendants(index);
+    index = 2 * index + !compare_(key, data_[index - 1]);
+  }
+  return last_left_turn(index);
+}
+
+template <typename data_type, typename compare>
+template <typename key_type>
+typename s21::eytzinger_tree<data_type, compare>::const_iterator
+s21::eytzinger_tree<data_type, compare>::find_by(const key_type& key) const {
+  size_t index = lower_index(key);
+  if (index == 0 || compare_(key, data_[index - 1])) return end();
+  return const_iterator(this, index);
+}
+
+template <typename data_type, typename compare>
+typename s21::eytzinger_tree<data_type, compare>::const_iterator&
+s21::eytzinger_tree<data_type, compare>::const_iterator::operator++() {
+  index_ = next_index(index_, tree_->size());
+  return *this;
+}
+
+template <typename data_type, typename compare>
+typename s21::eytzinger_tree<data_type, compare>::const_iterator
+s21::eytzinger_tree<data_type, compare>::const_iterator::operator++(int) {
+  const_iterator previous(*this);
+  ++*this;
+  return previous;
+}
+
+#endif
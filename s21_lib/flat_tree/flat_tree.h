@@ -0,0 +1,372 @@
+#ifndef S21_FLAT_TREE
+#define S21_FLAT_TREE
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "../s21_vector.h"
+
+namespace s21 {
+// Упорядоченный массив уникальных элементов поверх s21::vector: поиск
+// двоичный без ветвлений, вставка и удаление сдвигают хвост массива.
+// Итераторы - указатели, любое изменение делает их недействительными.
+template <typename data_type, typename compare = std::less<data_type>>
+class flat_tree {
+ public:
+  using iterator = data_type*;
+  using const_iterator = const data_type*;
+
+  flat_tree() = default;
+  flat_tree(std::initializer_list<data_type> const& items)
+      : flat_tree(items.begin(), items.end()) {}
+  template <typename input_iterator,
+            typename = typename std::iterator_traits<
+                input_iterator>::iterator_category>
+  flat_tree(input_iterator first, input_iterator last);
+  flat_tree(const flat_tree& other) = default;
+  flat_tree(flat_tree&& other) noexcept
+      : compare_(std::move(other.compare_)), data_(std::move(other.data_)) {}
+  ~flat_tree() = default;
+
+  flat_tree& operator=(const flat_tree& other) = default;
+  flat_tree& operator=(flat_tree&& other) noexcept;
+
+  iterator begin() { return data_.begin(); }
+  iterator end() { return data_.end(); }
+  const_iterator begin() const { return data_.begin(); }
+  const_iterator end() const { return data_.end(); }
+  const_iterator cbegin() const { return data_.begin(); }
+  const_iterator cend() const { return data_.end(); }
+  data_type& front() { return *begin(); }
+  data_type& back() { return *(end() - 1); }
+
+  bool empty() const noexcept { return data_.size() == 0; }
+  size_t size() const noexcept { return data_.size(); }
+  size_t max_size() const noexcept {
+    return std::numeric_limits<size_t>::max() / sizeof(data_type);
+  }
+  size_t capacity() { return data_.capacity(); }
+  void reserve(size_t count) { data_.reserve(count); }
+  void shrink_to_fit() { data_.shrink_to_fit(); }
+
+  iterator find(const data_type& value) { return find_by(value); }
+  const_iterator find(const data_type& value) const { return find_by(value); }
+  iterator lower_bound(const data_type& value) {
+    return lower_bound_by(value);
+  }
+  const_iterator lower_bound(const data_type& value) const {
+    return lower_bound_by(value);
+  }
+  iterator upper_bound(const data_type& value) {
+    return upper_bound_by(value);
+  }
+  const_iterator upper_bound(const data_type& value) const {
+    return upper_bound_by(value);
+  }
+  std::pair<iterator, iterator> equal_range(const data_type& value) {
+    return {lower_bound(value), upper_bound(value)};
+  }
+  std::pair<const_iterator, const_iterator> equal_range(
+      const data_type& value) const {
+    return {lower_bound(value), upper_bound(value)};
+  }
+
+  void clear() { data_.clear(); }
+  void erase(iterator pos) { data_.erase(pos); }
+  iterator erase(iterator first, iterator last);
+  size_t erase(const data_type& value) { return erase_by(value); }
+  template <typename predicate>
+  size_t erase_if(predicate pred);
+  void swap(flat_tree& other) noexcept;
+  // элементы other, которых здесь нет, переезжают сюда одним проходом
+  void merge(flat_tree& other);
+
+ protected:
+  compare compare_;
+  s21::vector<data_type> data_;
+
+  // поиск по ключу, сравнимому с элементами через compare
+  template <typename key_type>
+  iterator find_by(const key_type& key);
+  template <typename key_type>
+  const_iterator find_by(const key_type& key) const;
+  template <typename key_type>
+  iterator lower_bound_by(const key_type& key) {
+    return begin() + lower_index(key);
+  }
+  template <typename key_type>
+  const_iterator lower_bound_by(const key_type& key) const {
+    return begin() + lower_index(key);
+  }
+  template <typename key_type>
+  iterator upper_bound_by(const key_type& key) {
+    return begin() + upper_index(key);
+  }
+  template <typename key_type>
+  const_iterator upper_bound_by(const key_type& key) const {
+    return begin() + upper_index(key);
+  }
+  template <typename key_type>
+  size_t erase_by(const key_type& key);
+
+  std::pair<iterator, bool> insert_data(const data_type& value) {
+    return insert_unique(data_type(value));
+  }
+  std::pair<iterator, bool> insert_unique(data_type&& value);
+  iterator insert_hint(const_iterator hint, const data_type& value) {
+    return insert_hint(hint, data_type(value));
+  }
+  iterator insert_hint(const_iterator hint, data_type&& value);
+  template <typename... Args>
+  std::pair<iterator, bool> emplace_data(Args&&... args) {
+    return insert_unique(data_type(std::forward<Args>(args)...));
+  }
+  template <typename... Args>
+  iterator emplace_hint_data(const_iterator hint, Args&&... args) {
+    return insert_hint(hint, data_type(std::forward<Args>(args)...));
+  }
+  // все аргументы сортируются и вливаются в массив за один проход
+  template <typename... Args>
+  std::vector<std::pair<iterator, bool>> insert_batch(Args&&... args);
+
+ private:
+  template <typename key_type>
+  size_t lower_index(const key_type& key) const;
+  template <typename key_type>
+  size_t upper_index(const key_type& key) const;
+  // batch вливается в массив; из равных остается встреченный раньше,
+  // существующие элементы главнее новых. positions[i] - индекс элемента,
+  // равного batch[i], inserted[i] - попал ли в массив сам batch[i]
+  void merge_batch(std::vector<data_type>& batch,
+                   std::vector<size_t>& positions,
+                   std::vector<bool>& inserted);
+};
+
+template <typename data_type, typename compare, typename predicate>
+size_t erase_if(flat_tree<data_type, compare>& tree, predicate pred) {
+  return tree.erase_if(pred);
+}
+}  // namespace s21
+
+template <typename data_type, typename compare>
+template <typename input_iterator, typename>
+s21::flat_tree<data_type, compare>::flat_tree(input_iterator first,
+                                              input_iterator last) {
+  std::vector<data_type> batch(first, last);
+  std::vector<size_t> positions;
+  std::vector<bool> inserted;
+  merge_batch(batch, positions, inserted);
+}
+
+template <typename data_type, typename compare>
+s21::flat_tree<data_type, compare>&
+s21::flat_tree<data_type, compare>::operator=(flat_tree&& other) noexcept {
+  if (this != &other) {
+    compare_ = std::move(other.compare_);
+    data_ = std::move(other.data_);
+  }
+  return *this;
+}
+
+// Каждый шаг сужает отрезок вдвое выбором через условное присваивание,
+// число итераций зависит только от размера, так что переход на следующую
+// итерацию предсказывается всегда.
+template <typename data_type, typename compare>
+template <typename key_type>
+size_t s21::flat_tree<data_type, compare>::lower_index(
+    const key_type& key) const {
+  const data_type* first = data_.data();
+  size_t count = data_.size();
+  if (count == 0) return 0;
+  while (count > 1) {
+    size_t half = count / 2;
+    first = compare_(first[half], key) ? first + half : first;
+    count -= half;
+  }
+  return (first - data_.data()) + compare_(*first, key);
+}
+
+template <typename data_type, typename compare>
+template <typename key_type>
+size_t s21::flat_tree<data_type, compare>::upper_index(
+    const key_type& key) const {
+  const data_type* first = data_.data();
+  size_t count = data_.size();
+  if (count == 0) return 0;
+  while (count > 1) {
+    size_t half = count / 2;
+    first = compare_(key, first[half]) ? first : first + half;
+    count -= half;
+  }
+  return (first - data_.data()) + !compare_(key, *first);
+}
+
+template <typename data_type, typename compare>
+template <typename key_type>
+typename s21::flat_tree<data_type, compare>::iterator
+s21::flat_tree<data_type, compare>::find_by(const key_type& key) {
+  iterator found = lower_bound_by(key);
+  return found != end() && !compare_(key, *found) ? found : end();
+}
+
+template <typename data_type, typename compare>
+template <typename key_type>
+typename s21::flat_tree<data_type, compare>::const_iterator
+s21::flat_tree<data_type, compare>::find_by(const key_type& key) const {
+  const_iterator found = lower_bound_by(key);
+  return found != end() && !compare_(key, *found) ? found : end();
+}
+
+template <typename data_type, typename compare>
+template <typename key_type>
+size_t s21::flat_tree<data_type, compare>::erase_by(const key_type& key) {
+  iterator found = find_by(key);
+  if (found == end()) return 0;
+  data_.erase(found);
+  return 1;
+}
+
+template <typename data_type, typename compare>
+typename s21::flat_tree<data_type, compare>::iterator
+s21::flat_tree<data_type, compare>::erase(iterator first, iterator last) {
+  size_t removed = last - first;
+  std::move(last, end(), first);
+  for (size_t i = 0; i < removed; ++i) {
+    data_.pop_back();
+  }
+  return first;
+}
+
+template <typename data_type, typename compare>
+template <typename predicate>
+size_t s21::flat_tree<data_type, compare>::erase_if(predicate pred) {
+  iterator kept_end = std::remove_if(begin(), end(), pred);
+  size_t removed = end() - kept_end;
+  erase(kept_end, end());
+  return removed;
+}
+
+template <typename data_type, typename compare>
+void s21::flat_tree<data_type, compare>::swap(flat_tree& other) noexcept {
+  std::swap(compare_, other.compare_);
+  data_.swap(other.data_);
+}
+
+template <typename data_type, typename compare>
+std::pair<typename s21::flat_tree<data_type, compare>::iterator, bool>
+s21::flat_tree<data_type, compare>::insert_unique(data_type&& value) {
+  size_t index = lower_index(value);
+  if (index != size() && !compare_(value, data_[index])) {
+    return {begin() + index, false};
+  }
+  return {data_.insert(begin() + index, std::move(value)), true};
+}
+
+// Подсказка верна, если value встает ровно перед hint; иначе обычный
+// поиск
+template <typename data_type, typename compare>
+typename s21::flat_tree<data_type, compare>::iterator
+s21::flat_tree<data_type, compare>::insert_hint(const_iterator hint,
+                                                data_type&& value) {
+  iterator position = begin() + (hint - cbegin());
+  if ((position == begin() || compare_(*(position - 1), value)) &&
+      (position == end() || compare_(value, *position))) {
+    return data_.insert(position, std::move(value));
+  }
+  return insert_unique(std::move(value)).first;
+}
+
+template <typename data_type, typename compare>
+template <typename... Args>
+std::vector<
+    std::pair<typename s21::flat_tree<data_type, compare>::iterator, bool>>
+s21::flat_tree<data_type, compare>::insert_batch(Args&&... args) {
+  std::vector<data_type> batch;
+  batch.reserve(sizeof...(args));
+  (batch.emplace_back(std::forward<Args>(args)), ...);
+  std::vector<size_t> positions;
+  std::vector<bool> inserted;
+  merge_batch(batch, positions, inserted);
+
+  std::vector<std::pair<iterator, bool>> result;
+  result.reserve(batch.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    result.emplace_back(begin() + positions[i], inserted[i]);
+  }
+  return result;
+}
+
+// Новые элементы упорядочиваются устойчиво по индексам, затем массив
+// собирается заново за один проход слиянием
+template <typename data_type, typename compare>
+void s21::flat_tree<data_type, compare>::merge_batch(
+    std::vector<data_type>& batch, std::vector<size_t>& positions,
+    std::vector<bool>& inserted) {
+  std::vector<size_t> order(batch.size());
+  std::iota(order.begin(), order.end(), size_t(0));
+  std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return compare_(batch[lhs], batch[rhs]);
+  });
+  positions.assign(batch.size(), 0);
+  inserted.assign(batch.size(), false);
+
+  s21::vector<data_type> merged;
+  merged.reserve(size() + batch.size());
+  size_t left = 0;
+  bool last_is_new = false;
+  for (size_t index : order) {
+    data_type& value = batch[index];
+    while (left < size() && compare_(data_[left], value)) {
+      merged.push_back(std::move(data_[left++]));
+      last_is_new = false;
+    }
+    if (left < size() && !compare_(value, data_[left])) {
+      // равный существующий элемент ляжет следующим
+      positions[index] = merged.size();
+    } else if (last_is_new && !compare_(merged[merged.size() - 1], value)) {
+      positions[index] = merged.size() - 1;
+    } else {
+      positions[index] = merged.size();
+      inserted[index] = true;
+      merged.push_back(std::move(value));
+      last_is_new = true;
+    }
+  }
+  while (left < size()) {
+    merged.push_back(std::move(data_[left++]));
+  }
+  data_ = std::move(merged);
+}
+
+template <typename data_type, typename compare>
+void s21::flat_tree<data_type, compare>::merge(flat_tree& other) {
+  if (this == &other) return;
+  s21::vector<data_type> merged;
+  s21::vector<data_type> rest;
+  merged.reserve(size() + other.size());
+  size_t left = 0;
+  for (data_type& value : other.data_) {
+    while (left < size() && compare_(data_[left], value)) {
+      merged.push_back(std::move(data_[left++]));
+    }
+    if (left < size() && !compare_(value, data_[left])) {
+      rest.push_back(std::move(value));
+    } else {
+      merged.push_back(std::move(value));
+    }
+  }
+  while (left < size()) {
+    merged.push_back(std::move(data_[left++]));
+  }
+  data_ = std::move(merged);
+  other.data_ = std::move(rest);
+}
+
+#endif
@@ -0,0 +1,489 @@
+#ifndef S21_PERSISTENT_RB_TREE
+#define S21_PERSISTENT_RB_TREE
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace s21 {
+// Неизменяемое красно-черное дерево. Вставка и удаление не трогают
+// существующие узлы: копируется только путь от корня, O(log n) узлов,
+// остальное новая версия делит со старой. Узлы разделяются через
+// shared_ptr, поэтому копия дерева - снимок за O(1), а версии можно
+// читать и освобождать из разных потоков. Узел и его счетчик ссылок
+// выделяются одним блоком через std::make_shared.
+template <typename data_type, typename compare = std::less<data_type>>
+class persistent_rb_tree {
+ protected:
+  enum color_node { red, black };
+  struct node;
+  using link = std::shared_ptr<const node>;
+
+ public:
+  class const_iterator;
+  using iterator = const_iterator;
+
+  persistent_rb_tree() = default;
+  persistent_rb_tree(std::initializer_list<data_type> const& items);
+  persistent_rb_tree(const persistent_rb_tree& other) = default;
+  persistent_rb_tree(persistent_rb_tree&& other) noexcept = default;
+  ~persistent_rb_tree() = default;
+  persistent_rb_tree& operator=(const persistent_rb_tree& other) = default;
+  persistent_rb_tree& operator=(persistent_rb_tree&& other) noexcept =
+      default;
+
+  // итераторы действительны, пока жива хотя бы одна копия версии
+  const_iterator begin() const;
+  const_iterator end() const { return const_iterator(); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  bool empty() const noexcept { return size_ == 0; }
+  size_t size() const noexcept { return size_; }
+  // число изменений, которыми версия получена из пустого дерева
+  size_t version() const noexcept { return version_; }
+
+  const_iterator find(const data_type& value) const { return find_by(value); }
+  const_iterator lower_bound(const data_type& value) const {
+    return lower_bound_by(value);
+  }
+  bool contains(const data_type& value) const {
+    return find(value) != end();
+  }
+
+  // Изменения возвращают новую версию, *this остается прежним. Если
+  // менять нечего, возвращается та же версия.
+  persistent_rb_tree insert(const data_type& value) const {
+    return insert_value(value, false);
+  }
+  persistent_rb_tree insert_or_assign(const data_type& value) const {
+    return insert_value(value, true);
+  }
+  persistent_rb_tree erase(const data_type& value) const {
+    return erase_by(value);
+  }
+
+  // делят ли версии корень, т.е. одна не менялась относительно другой
+  bool same_version(const persistent_rb_tree& other) const noexcept {
+    return root_ == other.root_;
+  }
+  bool is_balanced() const;
+
+ protected:
+  template <typename key_type>
+  const_iterator find_by(const key_type& key) const;
+  template <typename key_type>
+  const_iterator lower_bound_by(const key_type& key) const;
+  persistent_rb_tree insert_value(const data_type& value, bool assign) const;
+  template <typename key_type>
+  persistent_rb_tree erase_by(const key_type& key) const;
+
+ private:
+  link root_;
+  size_t size_ = 0;
+  size_t version_ = 0;
+  compare compare_;
+
+  static bool is_red(const link& tree) noexcept {
+    return tree != nullptr && tree->color_ == red;
+  }
+  static bool is_black_node(const link& tree) noexcept {
+    return tree != nullptr && tree->color_ == black;
+  }
+  static link make(color_node color, const link& left, const data_type& data,
+                   const link& right) {
+    return std::make_shared<const node>(color, left, data, right);
+  }
+  static link recolor(const link& tree, color_node color) {
+    if (tree->color_ == color) return tree;
+    return make(color, tree->left_, tree->data_, tree->right_);
+  }
+
+  link insert_node(const link& tree, const data_type& value, bool assign,
+                   bool& inserted) const;
+  template <typename key_type>
+  link erase_node(const link& tree, const key_type& key, bool& erased) const;
+  static link balance(const link& left, const data_type& data,
+                      const link& right);
+  static link balance_left(const link& left, const data_type& data,
+                           const link& right);
+  static link balance_right(const link& left, const data_type& data,
+                            const link& right);
+  static link append(const link& left, const link& right);
+  int black_height(const node* tree) const;
+};
+
+template <typename data_type, typename compare>
+struct persistent_rb_tree<data_type, compare>::node {
+  node(color_node color, const link& left, const data_type& data,
+       const link& right)
+      : data_(data), left_(left), right_(right), color_(color) {}
+
+  const data_type data_;
+  const link left_;
+  const link right_;
+  const color_node color_;
+};
+
+// Стек узлов, в левых поддеревьях которых стоит итератор; вершина -
+// текущий узел, пустой стек - конец.
+template <typename data_type, typename compare>
+class persistent_rb_tree<data_type, compare>::const_iterator {
+  friend class persistent_rb_tree;
+
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = data_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const data_type*;
+  using reference = const data_type&;
+
+  const_iterator() = default;
+
+  reference operator*() const { return path_.back()->data_; }
+  pointer operator->() const { return &path_.back()->data_; }
+  const_iterator& operator++();
+  const_iterator operator++(int);
+  bool operator==(const const_iterator& other) const;
+  bool operator!=(const const_iterator& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  std::vector<const node*> path_;
+
+  void push_leftmost(const node* tree);
+};
+
+// Версия для чтения из многих потоков при одном писателе: читатель берет
+// снимок атомарной загрузкой и дальше не синхронизируется вовсе, писатели
+// упорядочены между собой мьютексом и публикуют готовую версию целиком.
+template <typename persistent>
+class versioned {
+ public:
+  versioned() : current_(std::make_shared<const persistent>()) {}
+  explicit versioned(persistent initial)
+      : current_(std::make_shared<const persistent>(std::move(initial))) {}
+  versioned(const versioned& other) = delete;
+  versioned& operator=(const versioned& other) = delete;
+
+  persistent snapshot() const { return *std::atomic_load(&current_); }
+  // next = func(текущая версия) становится текущей и возвращается
+  template <typename function>
+  persistent update(function&& func);
+
+ private:
+  std::shared_ptr<const persistent> current_;
+  std::mutex writer_;
+};
+}  // namespace s21
+
+template <typename data_type, typename compare>
+s21::persistent_rb_tree<data_type, compare>::persistent_rb_tree(
+    std::initializer_list<data_type> const& items) {
+  bool inserted = false;
+  for (const data_type& item : items) {
+    inserted = false;
+    root_ = recolor(insert_node(root_, item, false, inserted), black);
+    size_ += inserted;
+  }
+  version_ = size_;
+}
+
+template <typename data_type, typename compare>
+typename s21::persistent_rb_tree<data_type, compare>::const_iterator
+s21::persistent_rb_tree<data_type, compare>::begin() const {
+  const_iterator result;
+  result.push_leftmost(root_.get());
+  return result;
+}
+
+template <typename data_type, typename compare>
+template <typename key_type>
+typename s21::persistent_rb_tree<data_type, compare>::const_iterator
+s21::persistent_rb_tree<data_type, compare>::lower_bound_by(
+    const key_type& key) const {
+  const_iterator result;
+  const node* tree = root_.get();
+  while (tree != nullptr) {
+    if (compare_(tree->data_, key)) {
+      tree = tree->right_.get();
+    } else {
+      result.path_.push_back(tree);
+      tree = tree->left_.get();
+    }
+  }
+  return result;
+}
+
+template <typename data_type, typename compare>
+template <typename key_type>
+typename s21::persistent_rb_tree<data_type, compare>::const_iterator
+s21::persistent_rb_tree<data_type, compare>::find_by(
+    const key_type& key) const {
+  const_iterator result = lower_bound_by(key);
+  if (result != end() && compare_(key, *result)) return end();
+  return result;
+}
+
+template <typename data_type, typename compare>
+s21::persistent_rb_tree<data_type, compare>
+s21::persistent_rb_tree<data_type, compare>::insert_value(
+    const data_type& value, bool assign) const {
+  bool inserted = false;
+  link root = insert_node(root_, value, assign, inserted);
+  if (root == root_) return *this;
+  persistent_rb_tree result(*this);
+  result.root_ = recolor(root, black);
+  result.size_ += inserted;
+  ++result.version_;
+  return result;
+}
+
+template <typename data_type, typename compare>
+template <typename key_type>
+s21::persistent_rb_tree<data_type, compare>
+s21::persistent_rb_tree<data_type, compare>::erase_by(
+    const key_type& key) const {
+  bool erased = false;
+  link root = erase_node(root_, key, erased);
+  if (!erased) return *this;
+  persistent_rb_tree result(*this);
+  result.root_ = root != nullptr ? recolor(root, black) : nullptr;
+  --result.size_;
+  ++result.version_;
+  return result;
+}
+
+// Вставка по Окасаки: новый узел красный, балансировка на черных узлах
+// пути. Если поддерево не изменилось, возвращается оно же и путь выше
+// не копируется.
+template <typename data_type, typename compare>
+typename s21::persistent_rb_tree<data_type, compare>::link
+s21::persistent_rb_tree<data_type, compare>::insert_node(
+    const link& tree, const data_type& value, bool assign,
+    bool& inserted) const {
+  if (tree == nullptr) {
+    inserted = true;
+    return make(red, nullptr, value, nullptr);
+  }
+  if (compare_(value, tree->data_)) {
+    link left = insert_node(tree->left_, value, assign, inserted);
+    if (left == tree->left_) return tree;
+    return tree->color_ == black ? balance(left, tree->data_, tree->right_)
+                                 : make(red, left, tree->data_, tree->right_);
+  }
+  if (compare_(tree->data_, value)) {
+    link right = insert_node(tree->right_, value, assign, inserted);
+    if (right == tree->right_) return tree;
+    return tree->color_ == black ? balance(tree->left_, tree->data_, right)
+                                 : make(red, tree->left_, tree->data_, right);
+  }
+  if (!assign) return tree;
+  return make(tree->color_, tree->left_, value, tree->right_);
+}
+
+// Удаление по Карсу: спуск из черного узла может уменьшить черную высоту
+// поддерева, ее восстанавливают balance_left и balance_right.
+template <typename data_type, typename compare>
+template <typename key_type>
+typename s21::persistent_rb_tree<data_type, compare>::link
+s21::persistent_rb_tree<data_type, compare>::erase_node(const link& tree,
+                                                        const key_type& key,
+                                                        bool& erased) const {
+  if (tree == nullptr) return nullptr;
+  if (compare_(key, tree->data_)) {
+    link left = erase_node(tree->left_, key, erased);
+    if (!erased) return tree;
+    return is_black_node(tree->left_)
+               ? balance_left(left, tree->data_, tree->right_)
+               : make(red, left, tree->data_, tree->right_);
+  }
+  if (compare_(tree->data_, key)) {
+    link right = erase_node(tree->right_, key, erased);
+    if (!erased) return tree;
+    return is_black_node(tree->right_)
+               ? balance_right(tree->left_, tree->data_, right)
+               : make(red, tree->left_, tree->data_, right);
+  }
+  erased = true;
+  return append(tree->left_, tree->right_);
+}
+
+// Красный узел с красным потомком под черным родителем превращается в
+// красный узел с двумя черными
+template <typename data_type, typename compare>
+typename s21::persistent_rb_tree<data_type, compare>::link
+s21::persistent_rb_tree<data_type, compare>::balance(const link& left,
+                                                     const data_type& data,
+                                                     const link& right) {
+  if (is_red(left) && is_red(right)) {
+    return make(red, recolor(left, black), data, recolor(right, black));
+  }
+  if (is_red(left)) {
+    if (is_red(left->left_)) {
+      return make(red, recolor(left->left_, black), left->data_,
+                  make(black, left->right_, data, right));
+    }
+    if (is_red(left->right_)) {
+      const link& middle = left->right_;
+      return make(red, make(black, left->left_, left->data_, middle->left_),
+                  middle->data_, make(black, middle->right_, data, right));
+    }
+  }
+  if (is_red(right)) {
+    if (is_red(right->right_)) {
+      return make(red, make(black, left, data, right->left_), right->data_,
+                  recolor(right->right_, black));
+    }
+    if (is_red(right->left_)) {
+      const link& middle = right->left_;
+      return make(red, make(black, left, data, middle->left_), middle->data_,
+                  make(black, middle->right_, right->data_, right->right_));
+    }
+  }
+  return make(black, left, data, right);
+}
+
+// Черная высота left на единицу меньше, чем у right
+template <typename data_type, typename compare>
+typename s21::persistent_rb_tree<data_type, compare>::link
+s21::persistent_rb_tree<data_type, compare>::balance_left(
+    const link& left, const data_type& data, const link& right) {
+  if (is_red(left)) {
+    return make(red, recolor(left, black), data, right);
+  }
+  if (is_black_node(right)) {
+    return balance(left, data, recolor(right, red));
+  }
+  const link& middle = right->left_;
+  return make(red, make(black, left, data, middle->left_), middle->data_,
+              balance(middle->right_, right->data_,
+                      recolor(right->right_, red)));
+}
+
+// Черная высота right на единицу меньше, чем у left
+template <typename data_type, typename compare>
+typename s21::persistent_rb_tree<data_type, compare>::link
+s21::persistent_rb_tree<data_type, compare>::balance_right(
+    const link& left, const data_type& data, const link& right) {
+  if (is_red(right)) {
+    return make(red, left, data, recolor(right, black));
+  }
+  if (is_black_node(left)) {
+    return balance(recolor(left, red), data, right);
+  }
+  const link& middle = left->right_;
+  return make(red,
+              balance(recolor(left->left_, red), left->data_, middle->left_),
+              middle->data_, make(black, middle->right_, data, right));
+}
+
+// Склейка поддеревьев удаленного узла равной черной высоты
+template <typename data_type, typename compare>
+typename s21::persistent_rb_tree<data_type, compare>::link
+s21::persistent_rb_tree<data_type, compare>::append(const link& left,
+                                                    const link& right) {
+  if (left == nullptr) return right;
+  if (right == nullptr) return left;
+  if (is_red(left) && is_red(right)) {
+    link middle = append(left->right_, right->left_);
+    if (is_red(middle)) {
+      return make(red, make(red, left->left_, left->data_, middle->left_),
+                  middle->data_,
+                  make(red, middle->right_, right->data_, right->right_));
+    }
+    return make(red, left->left_, left->data_,
+                make(red, middle, right->data_, right->right_));
+  }
+  if (!is_red(left) && !is_red(right)) {
+    link middle = append(left->right_, right->left_);
+    if (is_red(middle)) {
+      return make(red, make(black, left->left_, left->data_, middle->left_),
+                  middle->data_,
+                  make(black, middle->right_, right->data_, right->right_));
+    }
+    return balance_left(left->left_, left->data_,
+                        make(black, middle, right->data_, right->right_));
+  }
+  if (is_red(right)) {
+    return make(red, append(left, right->left_), right->data_, right->right_);
+  }
+  return make(red, left->left_, left->data_, append(left->right_, right));
+}
+
+template <typename data_type, typename compare>
+bool s21::persistent_rb_tree<data_type, compare>::is_balanced() const {
+  return !is_red(root_) && black_height(root_.get()) >= 0;
+}
+
+// -1, если под узлом нарушен порядок, черная высота или красный узел
+// имеет красного потомка
+template <typename data_type, typename compare>
+int s21::persistent_rb_tree<data_type, compare>::black_height(
+    const node* tree) const {
+  if (tree == nullptr) return 0;
+  if (tree->color_ == red &&
+      (is_red(tree->left_) || is_red(tree->right_))) {
+    return -1;
+  }
+  if ((tree->left_ && !compare_(tree->left_->data_, tree->data_)) ||
+      (tree->right_ && !compare_(tree->data_, tree->right_->data_))) {
+    return -1;
+  }
+  int left = black_height(tree->left_.get());
+  int right = black_height(tree->right_.get());
+  if (left < 0 || left != right) return -1;
+  return left + (tree->color_ == black);
+}
+
+template <typename data_type, typename compare>
+void s21::persistent_rb_tree<data_type, compare>::const_iterator::
+    push_leftmost(const node* tree) {
+  for (; tree != nullptr; tree = tree->left_.get()) {
+    path_.push_back(tree);
+  }
+}
+
+template <typename data_type, typename compare>
+typename s21::persistent_rb_tree<data_type, compare>::const_iterator&
+s21::persistent_rb_tree<data_type, compare>::const_iterator::operator++() {
+  const node* current = path_.back();
+  path_.pop_back();
+  push_leftmost(current->right_.get());
+  return *this;
+}
+
+template <typename data_type, typename compare>
+typename s21::persistent_rb_tree<data_type, compare>::const_iterator
+s21::persistent_rb_tree<data_type, compare>::const_iterator::operator++(int) {
+  const_iterator previous(*this);
+  ++*this;
+  return previous;
+}
+
+template <typename data_type, typename compare>
+bool s21::persistent_rb_tree<data_type, compare>::const_iterator::operator==(
+    const const_iterator& other) const {
+  if (path_.empty() || other.path_.empty()) {
+    return path_.empty() == other.path_.empty();
+  }
+  return path_.back() == other.path_.back();
+}
+
+template <typename persistent>
+template <typename function>
+persistent s21::versioned<persistent>::update(function&& func) {
+  std::lock_guard<std::mutex> lock(writer_);
+  auto next = std::make_shared<const persistent>(
+      func(*std::atomic_load(&current_)));
+  std::atomic_store(&current_, next);
+  return *next;
+}
+
+#endif
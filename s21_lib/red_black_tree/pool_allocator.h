@@ -0,0 +1,269 @@
+#ifndef S21_POOL_ALLOCATOR
+#define S21_POOL_ALLOCATOR
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace s21 {
+
+// Пул блоков одного размера: блоки нарезаются из крупных слэбов,
+// освобожденные блоки уходят в список свободных и переиспользуются.
+// Размер блока задается первым запросом. Пул может быть общим для
+// контейнеров из разных потоков, поэтому операции идут под замком.
+class slab_pool {
+ public:
+  slab_pool() = default;
+  slab_pool(size_t size, size_t align) { serves(size, align); }
+  slab_pool(const slab_pool&) = delete;
+  slab_pool& operator=(const slab_pool&) = delete;
+  ~slab_pool();
+
+  // nullptr и false - блоки такого размера пул не обслуживает
+  void* allocate(size_t size, size_t align);
+  bool deallocate(void* ptr, size_t size, size_t align) noexcept;
+  // следующие blocks выделений идут подряд из одного слэба, минуя
+  // список свободных
+  void reserve(size_t blocks, size_t size, size_t align);
+
+ private:
+  struct free_block {
+    free_block* next_;
+  };
+  struct slab {
+    slab* next_;
+  };
+
+  static constexpr size_t min_slab_blocks = 32;
+  static constexpr size_t max_slab_blocks = 4096;
+
+  size_t block_size_ = 0;
+  size_t block_align_ = 0;
+  size_t slab_blocks_ = min_slab_blocks;
+  free_block* free_list_ = nullptr;
+  slab* slabs_ = nullptr;
+  char* cursor_ = nullptr;
+  char* slab_end_ = nullptr;
+  size_t reserved_ = 0;
+  std::mutex mutex_;
+
+  static size_t block_bytes(size_t size, size_t align) noexcept;
+  static size_t block_alignment(size_t align) noexcept {
+    return align < alignof(free_block) ? alignof(free_block) : align;
+  }
+  bool serves(size_t size, size_t align) noexcept;
+  void add_slab(size_t min_blocks);
+
+  friend class slab_pool_set;
+};
+
+// Общие пулы одного потока, по пулу на размер блока. Аллокатор помнит
+// набор, из которого взят его пул, и при rebind берет пул под новый
+// размер из того же набора, даже если rebind идет в другом потоке.
+class slab_pool_set {
+ public:
+  // набор вызывающего потока
+  static std::shared_ptr<slab_pool_set> local();
+
+  std::shared_ptr<slab_pool> pool_for(size_t size, size_t align);
+
+ private:
+  std::vector<std::shared_ptr<slab_pool>> pools_;
+  std::mutex mutex_;
+};
+
+// По умолчанию узлы берутся из общего пула потока, так что контейнеры,
+// созданные в одном потоке, имеют равные аллокаторы и передают друг другу
+// узлы (extract, merge, join) без выделений. Копия аллокатора и rebind
+// остаются на пулах потока-источника. isolated() дает контейнеру
+// собственный пул.
+
+template <typename T>
+class pool_allocator {
+  template <typename U>
+  friend class pool_allocator;
+
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
+
+  pool_allocator() : pool_allocator(slab_pool_set::local()) {}
+  pool_allocator(const pool_allocator& other) noexcept = default;
+  pool_allocator& operator=(const pool_allocator& other) noexcept = default;
+  // общий пул под размер T берется из набора источника
+  template <typename U>
+  pool_allocator(const pool_allocator<U>& other)
+      : pool_(other.pools_ ? other.pools_->pool_for(sizeof(T), alignof(T))
+                           : other.pool_),
+        pools_(other.pools_) {}
+
+  static pool_allocator isolated() {
+    return pool_allocator(std::make_shared<slab_pool>());
+  }
+
+  T* allocate(size_t n);
+  void deallocate(T* ptr, size_t n) noexcept;
+  void reserve(size_t n) { pool_->reserve(n, sizeof(T), alignof(T)); }
+  size_t max_size() const noexcept {
+    return std::allocator_traits<std::allocator<T>>::max_size(
+        std::allocator<T>());
+  }
+
+  pool_allocator select_on_container_copy_construction() const {
+    return pools_ ? pool_allocator() : isolated();
+  }
+
+  template <typename U>
+  bool operator==(const pool_allocator<U>& other) const noexcept {
+    return pool_ == other.pool_;
+  }
+  template <typename U>
+  bool operator!=(const pool_allocator<U>& other) const noexcept {
+    return pool_ != other.pool_;
+  }
+
+ private:
+  explicit pool_allocator(std::shared_ptr<slab_pool> pool)
+      : pool_(std::move(pool)) {}
+  explicit pool_allocator(std::shared_ptr<slab_pool_set> pools)
+      : pool_(pools->pool_for(sizeof(T), alignof(T))),
+        pools_(std::move(pools)) {}
+
+  std::shared_ptr<slab_pool> pool_;
+  // nullptr у изолированного аллокатора
+  std::shared_ptr<slab_pool_set> pools_;
+};
+}  // namespace s21
+
+inline s21::slab_pool::~slab_pool() {
+  while (slabs_ != nullptr) {
+    slab* next = slabs_->next_;
+    ::operator delete(slabs_);
+    slabs_ = next;
+  }
+}
+
+// Пулы потока живут, пока жив поток или хотя бы один аллокатор на них.
+inline std::shared_ptr<s21::slab_pool_set> s21::slab_pool_set::local() {
+  thread_local std::shared_ptr<slab_pool_set> pools =
+      std::make_shared<slab_pool_set>();
+  return pools;
+}
+
+inline std::shared_ptr<s21::slab_pool> s21::slab_pool_set::pool_for(
+    size_t size, size_t align) {
+  size_t bytes = slab_pool::block_bytes(size, align);
+  align = slab_pool::block_alignment(align);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const std::shared_ptr<slab_pool>& pool : pools_) {
+    // размер общего пула задан в конструкторе и больше не меняется
+    if (pool->block_size_ == bytes && pool->block_align_ == align) {
+      return pool;
+    }
+  }
+  pools_.push_back(std::make_shared<slab_pool>(size, align));
+  return pools_.back();
+}
+
+inline size_t s21::slab_pool::block_bytes(size_t size, size_t align) noexcept {
+  align = block_alignment(align);
+  if (size < sizeof(free_block)) size = sizeof(free_block);
+  return (size + align - 1) / align * align;
+}
+
+inline bool s21::slab_pool::serves(size_t size, size_t align) noexcept {
+  size = block_bytes(size, align);
+  align = block_alignment(align);
+  if (block_size_ == 0) {
+    block_size_ = size;
+    block_align_ = align;
+  }
+  // слэбы выровнены как operator new, для строже выровненных блоков пул
+  // только хранит размер
+  return size == block_size_ && align == block_align_ &&
+         align <= alignof(std::max_align_t);
+}
+
+inline void* s21::slab_pool::allocate(size_t size, size_t align) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!serves(size, align)) return nullptr;
+  if (reserved_ > 0) {
+    --reserved_;
+  } else if (free_list_ != nullptr) {
+    free_block* block = free_list_;
+    free_list_ = block->next_;
+    return block;
+  }
+  if (cursor_ == slab_end_) {
+    add_slab(1);
+  }
+  void* block = cursor_;
+  cursor_ += block_size_;
+  return block;
+}
+
+inline bool s21::slab_pool::deallocate(void* ptr, size_t size,
+                                       size_t align) noexcept {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!serves(size, align)) return false;
+  free_block* block = static_cast<free_block*>(ptr);
+  block->next_ = free_list_;
+  free_list_ = block;
+  return true;
+}
+
+// Если в текущем слэбе места не хватает, его остаток уходит в список
+// свободных, а под резерв заводится новый слэб.
+inline void s21::slab_pool::reserve(size_t blocks, size_t size,
+                                    size_t align) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!serves(size, align)) return;
+  if (static_cast<size_t>(slab_end_ - cursor_) < blocks * block_size_) {
+    for (; cursor_ != slab_end_; cursor_ += block_size_) {
+      free_block* block = reinterpret_cast<free_block*>(cursor_);
+      block->next_ = free_list_;
+      free_list_ = block;
+    }
+    add_slab(blocks);
+  }
+  reserved_ = blocks;
+}
+
+inline void s21::slab_pool::add_slab(size_t min_blocks) {
+  size_t blocks = slab_blocks_ < min_blocks ? min_blocks : slab_blocks_;
+  size_t header = (sizeof(slab) + block_align_ - 1) / block_align_ *
+                  block_align_;
+  char* memory =
+      static_cast<char*>(::operator new(header + blocks * block_size_));
+  slab* new_slab = reinterpret_cast<slab*>(memory);
+  new_slab->next_ = slabs_;
+  slabs_ = new_slab;
+  cursor_ = memory + header;
+  slab_end_ = cursor_ + blocks * block_size_;
+  if (slab_blocks_ < max_slab_blocks) {
+    slab_blocks_ *= 2;
+  }
+}
+
+template <typename T>
+T* s21::pool_allocator<T>::allocate(size_t n) {
+  if (n == 1) {
+    void* block = pool_->allocate(sizeof(T), alignof(T));
+    if (block != nullptr) return static_cast<T*>(block);
+  }
+  return std::allocator<T>().allocate(n);
+}
+
+template <typename T>
+void s21::pool_allocator<T>::deallocate(T* ptr, size_t n) noexcept {
+  if (n != 1 || !pool_->deallocate(ptr, sizeof(T), alignof(T))) {
+    std::allocator<T>().deallocate(ptr, n);
+  }
+}
+
+#endif
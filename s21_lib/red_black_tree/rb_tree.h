@@ -1,12 +1,80 @@
 #ifndef S21_RB_TREE
 #define S21_RB_TREE
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
 #include <limits>
+#include <optional>
 #include <stack>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "pool_allocator.h"
+#include "thread_pool.h"
 
 namespace s21 {
 
-template <typename data_type, typename compare = std::less<data_type>>
+template <typename compare, typename = void>
+struct is_transparent : std::false_type {};
+template <typename compare>
+struct is_transparent<compare, std::void_t<typename compare::is_transparent>>
+    : std::true_type {};
+
+template <typename alloc, typename = void>
+struct has_reserve : std::false_type {};
+template <typename alloc>
+struct has_reserve<alloc, std::void_t<decltype(std::declval<alloc&>().reserve(
+                              size_t()))>> : std::true_type {};
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+class rb_tree;
+
+// Подсказка процессору загрузить строку кэша по адресу заранее; адрес
+// может быть нулевым, обращения к памяти не происходит.
+inline void prefetch_line(const void* address) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address);
+#else
+  (void)address;
+#endif
+}
+
+// Необязательные возможности дерева. order_statistics хранит в узле размер
+// поддерева: nth, rank и count_range работают за O(log n) ценой одного
+// size_t на узел. prefetch на спуске заранее загружает обоих потомков
+// узла, пока сравнивается его ключ, а при обходе - узел, следующий за
+// текущим; выигрыш есть на деревьях, не помещающихся в кэш.
+// backend - дерево, на котором строится контейнер; stable_iterators -
+// итераторы и ссылки переживают вставку и удаление других элементов.
+template <bool order_statistics_ = false, bool prefetch_ = false>
+struct tree_options {
+  static constexpr bool order_statistics = order_statistics_;
+  static constexpr bool prefetch = prefetch_;
+  static constexpr bool stable_iterators = true;
+  template <typename data_type, typename compare, typename allocator,
+            typename options>
+  using backend = rb_tree<data_type, compare, allocator, options>;
+};
+
+// База set, multiset и map, выбранная политикой options
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+using tree_base = typename options::template backend<data_type, compare,
+                                                     allocator, options>;
+
+template <bool enabled>
+struct subtree_size_field {};
+template <>
+struct subtree_size_field<true> {
+  size_t subtree_size_ = 1;
+};
+
+template <typename data_type, typename compare = std::less<data_type>,
+          typename allocator = pool_allocator<data_type>,
+          typename options = tree_options<>>
 class rb_tree {
  protected:
   enum color_node { red, black };
@@ -15,37 +83,151 @@ class rb_tree {
  public:
   class iterator;
   class const_iterator;
+  class node_handle;
+  struct insert_return_type;
+  using allocator_type = allocator;
 
   rb_tree() : root_(nullptr), size_(0){};
-  rb_tree(const rb_tree& other);
+  explicit rb_tree(const allocator_type& alloc)
+      : root_(nullptr), size_(0), node_alloc_(alloc) {}
+  rb_tree(const rb_tree& other) : rb_tree(other, execution::sequential) {}
+  // крупное дерево с execution::parallel копируется задачами пула
+  rb_tree(const rb_tree& other, execution policy);
   rb_tree(rb_tree&& other) noexcept;
   rb_tree(std::initializer_list<data_type> const& elem);
+  template <typename input_iterator,
+            typename = typename std::iterator_traits<
+                input_iterator>::iterator_category>
+  rb_tree(input_iterator first, input_iterator last);
   ~rb_tree() { clear(); }
 
   rb_tree& operator=(rb_tree&& other) noexcept;
 
-  iterator begin() { return iterator(root_ ? min_node(root_) : nullptr, this); }
+  iterator begin() { return iterator(leftmost_, this); }
   iterator end() { return iterator(nullptr, this); }
   iterator find(const data_type& value);
 
   const_iterator cbegin() const {
-    return const_iterator(root_ ? min_node(root_) : nullptr, this);
+    return const_iterator(leftmost_, this);
   }
   const_iterator cend() const { return const_iterator(nullptr, this); }
   const_iterator find(const data_type& value) const;
 
+  // поиск по ключу без построения значения (для прозрачного компаратора)
+  template <typename key_type, typename key_compare = compare,
+            typename = std::enable_if_t<is_transparent<key_compare>::value>>
+  iterator find(const key_type& key) {
+    return iterator(find_node(key), this);
+  }
+  template <typename key_type, typename key_compare = compare,
+            typename = std::enable_if_t<is_transparent<key_compare>::value>>
+  const_iterator find(const key_type& key) const {
+    return const_iterator(find_node(key), this);
+  }
+
+  // Итераторы найденных элементов (end() для отсутствующих) пишутся в out
+  // в порядке ключей. Ключи - значения или, при прозрачном компараторе,
+  // сравнимые с ними; диапазон ключей обходится один раз.
+  template <typename key_iterator, typename output_iterator>
+  output_iterator find_many(key_iterator first, key_iterator last,
+                            output_iterator out) {
+    find_nodes(first, last, [this, &out](node* found) {
+      *out++ = iterator(found, this);
+    });
+    return out;
+  }
+  template <typename key_iterator, typename output_iterator>
+  output_iterator find_many(key_iterator first, key_iterator last,
+                            output_iterator out) const {
+    find_nodes(first, last, [this, &out](node* found) {
+      *out++ = const_iterator(found, this);
+    });
+    return out;
+  }
+
+  iterator lower_bound(const data_type& value) {
+    return iterator(lower_bound_node(value), this);
+  }
+  const_iterator lower_bound(const data_type& value) const {
+    return const_iterator(lower_bound_node(value), this);
+  }
+  iterator upper_bound(const data_type& value) {
+    return iterator(upper_bound_node(value), this);
+  }
+  const_iterator upper_bound(const data_type& value) const {
+    return const_iterator(upper_bound_node(value), this);
+  }
+  std::pair<iterator, iterator> equal_range(const data_type& value) {
+    return {lower_bound(value), upper_bound(value)};
+  }
+  std::pair<const_iterator, const_iterator> equal_range(
+      const data_type& value) const {
+    return {lower_bound(value), upper_bound(value)};
+  }
+
+  // наименьший и наибольший элементы, дерево не должно быть пустым
+  const data_type& front() const { return leftmost_->data_; }
+  const data_type& back() const { return rightmost_->data_; }
+
   size_t size() const noexcept { return size_; }
   size_t max_size() const noexcept {
-    return std::allocator_traits<std::allocator<node>>::max_size(
-        std::allocator<node>());
+    return node_traits::max_size(node_alloc_);
   }
   bool empty() const noexcept { return size_ == 0; }
+  allocator_type get_allocator() const { return allocator_type(node_alloc_); }
 
   void clear();
-  virtual std::pair<iterator, bool> insert_data(const data_type& data);
+  std::pair<iterator, bool> insert_data(const data_type& data);
+  template <typename... Args>
+  std::pair<iterator, bool> emplace_data(Args&&... args);
+  template <typename value_type>
+  iterator insert_hint(iterator hint, value_type&& data);
   void erase(iterator pos);
+  iterator erase(iterator first, iterator last);
+  size_t erase(const data_type& value);
+  template <typename predicate>
+  size_t erase_if(predicate pred);
+  node_handle extract(iterator pos);
+  insert_return_type insert_handle(node_handle&& handle);
   void swap(rb_tree& other) noexcept;
   void merge(rb_tree& other);
+  template <typename input_iterator>
+  void assign_sorted(input_iterator first, input_iterator last);
+  // склейка с деревом right, все ключи которого не меньше pivot и ключей
+  // дерева; right остается пустым
+  void join(const data_type& pivot, rb_tree& right);
+  void join(rb_tree& right);
+  // объединение, пересечение и разности деревьев lhs и rhs заменяют
+  // содержимое дерева; для мультимножеств кратности как в std::set_union
+  void assign_union(const rb_tree& lhs, const rb_tree& rhs,
+                    execution policy = execution::sequential) {
+    assign_set_operation(lhs, rhs, set_operation::unite, policy);
+  }
+  void assign_intersection(const rb_tree& lhs, const rb_tree& rhs,
+                           execution policy = execution::sequential) {
+    assign_set_operation(lhs, rhs, set_operation::intersect, policy);
+  }
+  void assign_difference(const rb_tree& lhs, const rb_tree& rhs,
+                         execution policy = execution::sequential) {
+    assign_set_operation(lhs, rhs, set_operation::subtract, policy);
+  }
+  void assign_symmetric_difference(const rb_tree& lhs, const rb_tree& rhs,
+                                   execution policy = execution::sequential) {
+    assign_set_operation(lhs, rhs, set_operation::symmetric, policy);
+  }
+  // вставка упорядоченного диапазона; крупный диапазон вливается
+  // слиянием с пересборкой дерева за O(n + m)
+  template <typename input_iterator>
+  void insert_sorted(input_iterator first, input_iterator last,
+                     execution policy = execution::sequential);
+
+  // порядковая статистика, только для tree_options<true>
+  iterator nth(size_t index) { return iterator(nth_node(index), this); }
+  const_iterator nth(size_t index) const {
+    return const_iterator(nth_node(index), this);
+  }
+  size_t rank(const data_type& value) const { return rank_key(value); }
+  size_t count_range(const data_type& first, const data_type& last) const;
 
   // вспомогательные функции
   void print() const;
@@ -57,35 +239,261 @@ class rb_tree {
   bool is_balanced_red_black(node* node_curr) const;
 
  protected:
-  struct node {
+  // Цвет хранится в младшем бите указателя на родителя: узлы выровнены
+  // минимум по указателю, поэтому бит всегда свободен, а отдельное поле
+  // цвета с выравниванием не увеличивает размер узла.
+  struct node : subtree_size_field<options::order_statistics> {
     data_type data_;
     node* left_;
     node* right_;
-    node* parent_;
-    color_node color_;
-    node(const data_type& data, node* parent)
-        : data_(data),
+    template <typename... Args>
+    explicit node(node* parent, Args&&... args)
+        : data_(std::forward<Args>(args)...),
           left_(nullptr),
           right_(nullptr),
-          parent_(parent),
-          color_(red) {}
+          parent_color_(reinterpret_cast<uintptr_t>(parent) | red) {}
+
+    node* parent() const noexcept {
+      return reinterpret_cast<node*>(parent_color_ & ~color_mask);
+    }
+    void set_parent(node* parent) noexcept {
+      parent_color_ =
+          reinterpret_cast<uintptr_t>(parent) | (parent_color_ & color_mask);
+    }
+    color_node color() const noexcept {
+      return static_cast<color_node>(parent_color_ & color_mask);
+    }
+    void set_color(color_node color) noexcept {
+      parent_color_ = (parent_color_ & ~color_mask) | color;
+    }
+
+   private:
+    static constexpr uintptr_t color_mask = 1;
+    uintptr_t parent_color_;
   };
+  // узел - значение и три указателя: цвет места не занимает, поэтому
+  // max_size() больше, чем у std::map с отдельным полем цвета
+  static_assert(options::order_statistics ||
+                    alignof(data_type) > alignof(node*) ||
+                    sizeof(node) == (sizeof(data_type) + alignof(node*) - 1) /
+                                            alignof(node*) * alignof(node*) +
+                                        3 * sizeof(node*),
+                "rb_tree node must be the payload plus three pointers");
+
+  using node_allocator =
+      typename std::allocator_traits<allocator>::template rebind_alloc<node>;
+  using node_traits = std::allocator_traits<node_allocator>;
 
   node* root_;
   size_t size_;
+  // крайние узлы: begin() и --end() без спуска по дереву
+  node* leftmost_ = nullptr;
+  node* rightmost_ = nullptr;
   compare compare_;
+  node_allocator node_alloc_;
+
+  enum class hint_result { fits, equal, miss };
+  enum class set_operation { unite, intersect, subtract, symmetric };
+  // элемент результата слияния: готовый узел или значение для копирования
+  struct merge_item {
+    node* existing;
+    const data_type* value;
+  };
+  using merge_chunks = std::vector<std::vector<merge_item>>;
+  // сборка дерева из независимых поддеревьев глубины cut_depth
+  struct build_plan {
+    const std::vector<node*>& nodes;
+    size_t red_depth;
+    size_t cut_depth;
+    std::vector<std::pair<size_t, size_t>> slices;
+    std::vector<node*> subtrees;
+    size_t next_subtree;
+  };
+  // меньшие объемы быстрее обработать в одном потоке
+  static constexpr size_t parallel_threshold = size_t(1) << 14;
+  // корни частей разрезания и их черные высоты
+  struct split_parts {
+    node* left;
+    size_t left_height;
+    node* right;
+    size_t right_height;
+  };
 
-  node* copy_tree(node* src);
+  template <typename... Args>
+  node* create_node(node* parent, Args&&... args);
+  void destroy_node(node* node_curr) noexcept;
+  void destroy_tree(node* node_curr) noexcept;
+  void link_node(node* new_node, node* parent, bool as_left);
+  template <typename value_type>
+  std::pair<iterator, bool> insert_unique(value_type&& data);
+  template <typename value_type>
+  iterator insert_equal(value_type&& data) {
+    return insert_node(create_node(nullptr, std::forward<value_type>(data)))
+        .first;
+  }
+  std::pair<iterator, bool> insert_node(node* new_node);
+  iterator insert_node_hint(iterator hint, node* new_node);
+  template <typename... Args>
+  iterator emplace_hint_data(iterator hint, Args&&... args) {
+    return insert_node_hint(hint,
+                            create_node(nullptr, std::forward<Args>(args)...));
+  }
+  hint_result check_hint(iterator hint, const data_type& data,
+                         node*& position, bool& as_left);
+  template <typename key_type>
+  node* find_node(const key_type& key) const;
+  // число спусков, идущих одновременно в find_many
+  static constexpr size_t lookup_group = 16;
+  template <typename key_iterator, typename consumer>
+  void find_nodes(key_iterator first, key_iterator last,
+                  consumer&& emit) const;
+  template <typename key_type>
+  node* lower_bound_node(const key_type& key) const;
+  template <typename key_type>
+  node* upper_bound_node(const key_type& key) const;
+  // поиск по ключу любого сравнимого с элементами типа
+  template <typename key_type>
+  iterator find_by(const key_type& key) {
+    return iterator(find_node(key), this);
+  }
+  template <typename key_type>
+  const_iterator find_by(const key_type& key) const {
+    return const_iterator(find_node(key), this);
+  }
+  template <typename key_type>
+  iterator lower_bound_by(const key_type& key) {
+    return iterator(lower_bound_node(key), this);
+  }
+  template <typename key_type>
+  const_iterator lower_bound_by(const key_type& key) const {
+    return const_iterator(lower_bound_node(key), this);
+  }
+  template <typename key_type>
+  iterator upper_bound_by(const key_type& key) {
+    return iterator(upper_bound_node(key), this);
+  }
+  template <typename key_type>
+  const_iterator upper_bound_by(const key_type& key) const {
+    return const_iterator(upper_bound_node(key), this);
+  }
+  virtual bool allows_duplicates() const noexcept { return false; }
+  template <typename input_iterator>
+  bool is_sorted_range(input_iterator first, input_iterator last) const;
+  template <typename node_source>
+  void build_root(node_source& next, size_t count);
+  template <typename node_source>
+  node* build_sorted(node_source& next, size_t count, size_t depth,
+                     size_t red_depth);
+  static bool prefers_rebuild(size_t batch, size_t total) noexcept;
+  void rebuild_from(const std::vector<node*>& nodes,
+                    execution policy = execution::sequential);
+  size_t erase_range(iterator first, iterator last);
+  void merge_linear(rb_tree& other);
+  void assign_skewed_union(const rb_tree& lhs, const rb_tree& rhs,
+                           execution policy);
+  void assign_set_operation(const rb_tree& lhs, const rb_tree& rhs,
+                            set_operation operation, execution policy);
+  void merge_ranges(node* left, node* left_end, const rb_tree& rhs,
+                    node* right, node* right_end, set_operation operation,
+                    bool gallop, std::vector<merge_item>& out) const;
+  template <typename batch_iterator>
+  void merge_batch(node* tree_first, node* tree_last, batch_iterator first,
+                   batch_iterator last, std::vector<merge_item>& out) const;
+  std::vector<node*> materialize(const merge_chunks& chunks,
+                                 execution policy);
+  static size_t chunk_count(size_t total, execution policy);
+  template <typename function>
+  static void for_each_chunk(size_t count, execution policy,
+                             function&& func);
+  std::vector<const data_type*> splitters(size_t chunks) const;
+  static void collect_keys(const node* node_curr, size_t depth, size_t cut,
+                           std::vector<const data_type*>& keys);
+  static void collect_slices(build_plan& plan, size_t first, size_t count,
+                             size_t depth);
+  node* link_slices(build_plan& plan, size_t first, size_t count,
+                    size_t depth);
+  template <typename key_type>
+  void split_into(const key_type& key, rb_tree& right);
+  template <typename key_type>
+  split_parts split_nodes(node* root, size_t height, const key_type& key);
+  std::pair<node*, size_t> join_nodes(node* left, size_t left_height,
+                                      node* pivot, node* right,
+                                      size_t right_height);
+  void join_node(node* pivot, rb_tree& right);
+  bool in_order(const data_type& lhs, const data_type& rhs) const {
+    return allows_duplicates() ? !compare_(rhs, lhs) : compare_(lhs, rhs);
+  }
+  static size_t blacken_root(node* root) noexcept;
+  // копия поддерева с той же формой и цветами
+  struct clone_task {
+    const node* source;
+    node* parent;
+    node** slot;
+    std::vector<node*> memory;
+    size_t used;
+  };
+  node* copy_tree(const node* src, size_t count, execution policy);
+  template <typename node_factory>
+  void clone_into(const node* source, node* parent, node*& slot,
+                  node_factory& make);
+  void clone_top(const node* source, node* parent, node*& slot, size_t depth,
+                 size_t cut, std::vector<clone_task>& tasks);
+  static size_t count_nodes(const node* node_curr) noexcept;
+  void reserve_nodes(size_t count) {
+    if constexpr (has_reserve<node_allocator>::value) {
+      node_alloc_.reserve(count);
+    }
+  }
   node* max_node(node* node_curr) const;
   node* min_node(node* node_curr) const;
+  static node* next_node(node* node_curr) noexcept;
   void rotate_left(node* node_curr);
   void rotate_right(node* node_curr);
-  void fix_violation(node* node_curr);
-  void delete_fix(node* node_curr);
+  bool fix_violation(node* node_curr);
+  void delete_fix(node* node_curr, node* parent);
+  void replace_child(node* old_child, node* new_child) noexcept;
+  void unlink_node(node* node_curr) noexcept;
+  static void reset_node(node* node_curr) noexcept;
+  static size_t subtree_size(const node* node_curr) noexcept {
+    if constexpr (options::order_statistics) {
+      return node_curr ? node_curr->subtree_size_ : 0;
+    } else {
+      return 0;
+    }
+  }
+  static void update_size(node* node_curr) noexcept;
+  static void update_sizes_upward(node* node_curr) noexcept;
+  void reset_extremes() noexcept {
+    leftmost_ = root_ ? min_node(root_) : nullptr;
+    rightmost_ = root_ ? max_node(root_) : nullptr;
+  }
+  node* nth_node(size_t index) const;
+  template <typename key_type>
+  size_t rank_key(const key_type& key) const;
+  static bool is_black(const node* node_curr) noexcept {
+    return node_curr == nullptr || node_curr->color() == black;
+  }
+  static void prefetch_children(const node* node_curr) noexcept {
+    if constexpr (options::prefetch) {
+      prefetch_line(node_curr->left_);
+      prefetch_line(node_curr->right_);
+    }
+  }
+  // следующий за node_curr узел - самый левый в правом поддереве или
+  // один из предков; подгружается первый шаг к нему
+  static void prefetch_successor(const node* node_curr) noexcept {
+    if constexpr (options::prefetch) {
+      if (node_curr != nullptr) {
+        prefetch_line(node_curr->right_ ? node_curr->right_
+                                        : node_curr->parent());
+      }
+    }
+  }
 };
 
-template <typename data_type, typename compare>
-class rb_tree<data_type, compare>::iterator {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+class rb_tree<data_type, compare, allocator, options>::iterator {
  public:
   iterator() : ptr_(nullptr), tree_(nullptr) {}
   iterator(node* ptr, rb_tree* tree) : ptr_(ptr), tree_(tree) {}
@@ -114,8 +522,9 @@ class rb_tree<data_type, compare>::iterator {
   rb_tree* tree_;
 };
 
-template <typename data_type, typename compare>
-class rb_tree<data_type, compare>::const_iterator {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+class rb_tree<data_type, compare, allocator, options>::const_iterator {
  public:
   const_iterator() : ptr_(nullptr), tree_(nullptr) {}
   const_iterator(const node* ptr, const rb_tree* tree)
@@ -141,10 +550,104 @@ class rb_tree<data_type, compare>::const_iterator {
   const node* ptr_;
   const rb_tree* tree_;
 };
+
+// Владеющий дескриптор узла, вынутого из дерева: хранит узел вместе с копией
+// аллокатора и освобождает его, если узел так и не вставили обратно.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+class rb_tree<data_type, compare, allocator, options>::node_handle {
+  friend class rb_tree;
+
+ public:
+  node_handle() noexcept : ptr_(nullptr) {}
+  node_handle(node_handle&& other) noexcept
+      : ptr_(other.ptr_), alloc_(std::move(other.alloc_)) {
+    other.ptr_ = nullptr;
+    other.alloc_.reset();
+  }
+  node_handle& operator=(node_handle&& other) noexcept;
+  ~node_handle() { reset(); }
+
+  bool empty() const noexcept { return ptr_ == nullptr; }
+  explicit operator bool() const noexcept { return ptr_ != nullptr; }
+  allocator_type get_allocator() const { return allocator_type(*alloc_); }
+
+  data_type& value() const { return ptr_->data_; }
+  // для map: ключ можно поменять до повторной вставки
+  template <typename value_type = data_type>
+  auto& key() const {
+    return ptr_->data_.first;
+  }
+  template <typename value_type = data_type>
+  auto& mapped() const {
+    return ptr_->data_.second;
+  }
+
+  void swap(node_handle& other) noexcept {
+    std::swap(ptr_, other.ptr_);
+    std::swap(alloc_, other.alloc_);
+  }
+
+ private:
+  node_handle(node* ptr, const node_allocator& alloc)
+      : ptr_(ptr), alloc_(alloc) {}
+
+  void release() noexcept {
+    ptr_ = nullptr;
+    alloc_.reset();
+  }
+  void reset() noexcept;
+
+  node* ptr_;
+  std::optional<node_allocator> alloc_;
+};
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+struct rb_tree<data_type, compare, allocator, options>::insert_return_type {
+  iterator position;
+  bool inserted;
+  node_handle node;
+};
+
+// Удаляет все элементы, для которых pred истинен; подходит для set,
+// multiset и map.
+template <typename data_type, typename compare, typename allocator,
+          typename options, typename predicate>
+size_t erase_if(rb_tree<data_type, compare, allocator, options>& tree,
+                predicate pred) {
+  return tree.erase_if(pred);
+}
 }  // namespace s21
 
-template <typename data_type, typename compare>
-void s21::rb_tree<data_type, compare>::print() const {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::node_handle&
+s21::rb_tree<data_type, compare, allocator, options>::node_handle::operator=(
+    node_handle&& other) noexcept {
+  if (this != &other) {
+    reset();
+    ptr_ = other.ptr_;
+    alloc_ = std::move(other.alloc_);
+    other.release();
+  }
+  return *this;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator,
+                  options>::node_handle::reset() noexcept {
+  if (ptr_) {
+    node_traits::destroy(*alloc_, ptr_);
+    node_traits::deallocate(*alloc_, ptr_, 1);
+  }
+  release();
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::print() const {
   if (!root_) {
     std::cout << "Tree is empty" << std::endl;
     return;
@@ -168,8 +671,10 @@ void s21::rb_tree<data_type, compare>::print() const {
   std::cout << std::endl;
 }
 
-template <typename data_type, typename compare>
-bool s21::rb_tree<data_type, compare>::is_balanced_black_height(
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+bool
+s21::rb_tree<data_type, compare, allocator, options>::is_balanced_black_height(
     node* node_curr) const {
   if (node_curr == nullptr) return true;
 
@@ -182,70 +687,108 @@ bool s21::rb_tree<data_type, compare>::is_balanced_black_height(
          (left_black_height == right_black_height);
 }
 
-template <typename data_type, typename compare>
-int s21::rb_tree<data_type, compare>::black_height(node* node_curr) const {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+int s21::rb_tree<data_type, compare, allocator, options>::black_height(
+    node* node_curr) const {
   if (node_curr == nullptr) return 0;
   int left_black_height = black_height(node_curr->left_);
   int right_black_height = black_height(node_curr->right_);
-  int current_height = (node_curr->color_ == black) ? 1 : 0;
+  int current_height = (node_curr->color() == black) ? 1 : 0;
   return std::max(left_black_height, right_black_height) + current_height;
 }
 
-template <typename data_type, typename compare>
-bool s21::rb_tree<data_type, compare>::is_balanced_red_black(
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+bool
+s21::rb_tree<data_type, compare, allocator, options>::is_balanced_red_black(
     node* node_curr) const {
   if (node_curr == nullptr) return true;
   bool left_balanced = is_balanced_red_black(node_curr->left_);
   bool right_balanced = is_balanced_red_black(node_curr->right_);
-  if (node_curr->color_ == red) {
-    if (node_curr->left_ && node_curr->left_->color_ != black) return false;
-    if (node_curr->right_ && node_curr->right_->color_ != black) return false;
+  if (node_curr->color() == red) {
+    if (node_curr->left_ && node_curr->left_->color() != black) return false;
+    if (node_curr->right_ && node_curr->right_->color() != black) return false;
   }
   return left_balanced && right_balanced;
 }
 
-template <typename K, typename V>
-s21::rb_tree<K, V>::rb_tree(const rb_tree& other) {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+s21::rb_tree<data_type, compare, allocator, options>::rb_tree(
+    const rb_tree& other, execution policy)
+    : root_(nullptr),
+      size_(0),
+      compare_(other.compare_),
+      node_alloc_(node_traits::select_on_container_copy_construction(
+          other.node_alloc_)) {
   if (other.root_) {
-    root_ = copy_tree(other.root_);
+    root_ = copy_tree(other.root_, other.size_, policy);
     size_ = other.size_;
-    compare_ = other.compare_;
+    reset_extremes();
   }
 }
 
-template <typename K, typename V>
-s21::rb_tree<K, V>::rb_tree(rb_tree&& other) noexcept {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+s21::rb_tree<data_type, compare, allocator, options>::rb_tree(
+    rb_tree&& other) noexcept
+    : node_alloc_(other.node_alloc_) {
   root_ = other.root_;
   size_ = other.size_;
+  leftmost_ = other.leftmost_;
+  rightmost_ = other.rightmost_;
   compare_ = std::move(other.compare_);
   other.root_ = nullptr;
   other.size_ = 0;
+  other.leftmost_ = nullptr;
+  other.rightmost_ = nullptr;
 }
 
-template <typename data_type, typename compare>
-s21::rb_tree<data_type, compare>::rb_tree(
-    std::initializer_list<data_type> const& elem) {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+s21::rb_tree<data_type, compare, allocator, options>::rb_tree(
+    std::initializer_list<data_type> const& elem)
+    : root_(nullptr), size_(0) {
   for (const auto& item : elem) {
     insert_data(item);
   }
 }
 
-template <typename data_type, typename compare>
-s21::rb_tree<data_type, compare>& s21::rb_tree<data_type, compare>::operator=(
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename input_iterator, typename>
+s21::rb_tree<data_type, compare, allocator, options>::rb_tree(
+    input_iterator first, input_iterator last)
+    : root_(nullptr), size_(0) {
+  assign_sorted(first, last);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+s21::rb_tree<data_type, compare, allocator, options>&
+s21::rb_tree<data_type, compare, allocator, options>::operator=(
     rb_tree&& other) noexcept {
   if (this != &other) {
     clear();
     root_ = other.root_;
     size_ = other.size_;
+    leftmost_ = other.leftmost_;
+    rightmost_ = other.rightmost_;
     compare_ = other.compare_;
+    node_alloc_ = other.node_alloc_;
     other.root_ = nullptr;
     other.size_ = 0;
+    other.leftmost_ = nullptr;
+    other.rightmost_ = nullptr;
   }
   return *this;
 }
 
-template <typename data_type, typename compare>
-data_type& s21::rb_tree<data_type, compare>::iterator::operator*() {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+data_type&
+s21::rb_tree<data_type, compare, allocator, options>::iterator::operator*() {
   if (ptr_) {
     return ptr_->data_;
   } else {
@@ -253,8 +796,11 @@ data_type& s21::rb_tree<data_type, compare>::iterator::operator*() {
     return default_value;
   }
 }
-template <typename data_type, typename compare>
-const data_type& s21::rb_tree<data_type, compare>::iterator::operator*() const {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+const data_type&
+s21::rb_tree<data_type, compare, allocator,
+             options>::iterator::operator*() const {
   if (ptr_) {
     return ptr_->data_;
   } else {
@@ -263,65 +809,78 @@ const data_type& s21::rb_tree<data_type, compare>::iterator::operator*() const {
   }
 }
 
-template <typename data_type, typename compare>
-typename s21::rb_tree<data_type, compare>::iterator&
-s21::rb_tree<data_type, compare>::iterator::operator=(const iterator& other) {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::iterator&
+s21::rb_tree<data_type, compare, allocator, options>::iterator::operator=(
+    const iterator& other) {
   ptr_ = other.ptr_;
   tree_ = other.tree_;
   return *this;
 }
 
-template <typename data_type, typename compare>
-typename s21::rb_tree<data_type, compare>::iterator&
-s21::rb_tree<data_type, compare>::iterator::operator++() {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::iterator&
+s21::rb_tree<data_type, compare, allocator, options>::iterator::operator++() {
   if (ptr_->right_ != nullptr) {
     ptr_ = tree_->min_node(ptr_->right_);
   } else {
-    node* parent = ptr_->parent_;
+    node* parent = ptr_->parent();
     while (parent != nullptr && ptr_ == parent->right_) {
       ptr_ = parent;
-      parent = parent->parent_;
+      parent = parent->parent();
     }
     ptr_ = parent;
   }
+  prefetch_successor(ptr_);
   return *this;
 }
 
-template <typename data_type, typename compare>
-typename s21::rb_tree<data_type, compare>::iterator
-s21::rb_tree<data_type, compare>::iterator::operator++(int) {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::iterator
+s21::rb_tree<data_type, compare, allocator,
+             options>::iterator::operator++(int) {
   iterator temp = *this;
   operator++();
   return temp;
 }
 
-template <typename data_type, typename compare>
-typename s21::rb_tree<data_type, compare>::iterator&
-s21::rb_tree<data_type, compare>::iterator::operator--() {
-  if (ptr_->left_ != nullptr) {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::iterator&
+s21::rb_tree<data_type, compare, allocator, options>::iterator::operator--() {
+  if (ptr_ == nullptr) {
+    ptr_ = tree_->rightmost_;
+  } else if (ptr_->left_ != nullptr) {
     ptr_ = tree_->max_node(ptr_->left_);
   } else {
-    node* parent = ptr_->parent_;
+    node* parent = ptr_->parent();
     while (parent != nullptr && ptr_ == parent->left_) {
       ptr_ = parent;
-      parent = parent->parent_;
+      parent = parent->parent();
     }
     ptr_ = parent;
   }
   return *this;
 }
 
-template <typename data_type, typename compare>
-typename s21::rb_tree<data_type, compare>::iterator
-s21::rb_tree<data_type, compare>::iterator::operator--(int) {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::iterator
+s21::rb_tree<data_type, compare, allocator,
+             options>::iterator::operator--(int) {
   iterator temp = *this;
   operator--();
   return temp;
 }
 
-template <typename data_type, typename compare>
-const data_type& s21::rb_tree<data_type, compare>::const_iterator::operator*()
-    const {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+const data_type&
+s21::rb_tree<data_type, compare, allocator,
+             options>::const_iterator::operator*() const {
   if (ptr_) {
     return ptr_->data_;
   } else {
@@ -330,367 +889,1786 @@ const data_type& s21::rb_tree<data_type, compare>::const_iterator::operator*()
   }
 }
 
-template <typename data_type, typename compare>
-typename s21::rb_tree<data_type, compare>::const_iterator&
-s21::rb_tree<data_type, compare>::const_iterator::operator=(
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::const_iterator&
+s21::rb_tree<data_type, compare, allocator, options>::const_iterator::operator=(
     const const_iterator& other) {
   ptr_ = other.ptr_;
   tree_ = other.tree_;
   return *this;
 }
 
-template <typename data_type, typename compare>
-typename s21::rb_tree<data_type, compare>::const_iterator&
-s21::rb_tree<data_type, compare>::const_iterator::operator++() {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::const_iterator&
+s21::rb_tree<data_type, compare, allocator,
+             options>::const_iterator::operator++() {
   if (ptr_->right_ != nullptr) {
     ptr_ = tree_->min_node(ptr_->right_);
   } else {
-    node* parent = ptr_->parent_;
+    node* parent = ptr_->parent();
     while (parent != nullptr && ptr_ == parent->right_) {
       ptr_ = parent;
-      parent = parent->parent_;
+      parent = parent->parent();
     }
     ptr_ = parent;
   }
+  prefetch_successor(ptr_);
   return *this;
 }
 
-template <typename data_type, typename compare>
-typename s21::rb_tree<data_type, compare>::const_iterator
-s21::rb_tree<data_type, compare>::const_iterator::operator++(int) {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::const_iterator
+s21::rb_tree<data_type, compare, allocator,
+             options>::const_iterator::operator++(int) {
   const_iterator temp = *this;
   operator++();
   return temp;
 }
 
-template <typename data_type, typename compare>
-typename s21::rb_tree<data_type, compare>::const_iterator&
-s21::rb_tree<data_type, compare>::const_iterator::operator--() {
-  if (ptr_->left_ != nullptr) {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::const_iterator&
+s21::rb_tree<data_type, compare, allocator,
+             options>::const_iterator::operator--() {
+  if (ptr_ == nullptr) {
+    ptr_ = tree_->rightmost_;
+  } else if (ptr_->left_ != nullptr) {
     ptr_ = tree_->max_node(ptr_->left_);
   } else {
-    node* parent = ptr_->parent_;
+    node* parent = ptr_->parent();
     while (parent != nullptr && ptr_ == parent->left_) {
       ptr_ = parent;
-      parent = parent->parent_;
+      parent = parent->parent();
     }
     ptr_ = parent;
   }
   return *this;
 }
 
-template <typename data_type, typename compare>
-typename s21::rb_tree<data_type, compare>::const_iterator
-s21::rb_tree<data_type, compare>::const_iterator::operator--(int) {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::const_iterator
+s21::rb_tree<data_type, compare, allocator,
+             options>::const_iterator::operator--(int) {
   const_iterator temp = *this;
   operator--();
   return temp;
 }
 
-template <typename data_type, typename compare>  // ++
-typename s21::rb_tree<data_type, compare>::const_iterator
-s21::rb_tree<data_type, compare>::find(const data_type& value) const {
+template <typename data_type, typename compare, typename allocator,
+          typename options>  // ++
+typename s21::rb_tree<data_type, compare, allocator, options>::const_iterator
+s21::rb_tree<data_type, compare, allocator, options>::find(
+    const data_type& value) const {
+  return const_iterator(find_node(value), this);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename key_type>
+typename s21::rb_tree<data_type, compare, allocator, options>::node*
+s21::rb_tree<data_type, compare, allocator, options>::find_node(
+    const key_type& key) const {
   node* current = root_;
   while (current != nullptr) {
-    if (compare_(value, current->data_)) {
+    prefetch_children(current);
+    if (compare_(key, current->data_)) {
       current = current->left_;
-    } else if (compare_(current->data_, value)) {
+    } else if (compare_(current->data_, key)) {
       current = current->right_;
     } else {
-      return const_iterator(current, this);
+      return current;
+    }
+  }
+  return nullptr;
+}
+
+// Ключи берутся группами по lookup_group, спуски группы продвигаются по
+// очереди на один уровень. Следующий узел каждого спуска известен точно
+// и загружается заранее: пока сравниваются ключи остальных спусков,
+// промахи кэша разных спусков перекрываются.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename key_iterator, typename consumer>
+void s21::rb_tree<data_type, compare, allocator, options>::find_nodes(
+    key_iterator first, key_iterator last, consumer&& emit) const {
+  struct lane {
+    key_iterator key;
+    node* current;
+    node* found;
+  };
+  lane lanes[lookup_group];
+  while (first != last) {
+    size_t count = 0;
+    for (; count < lookup_group && first != last; ++count, ++first) {
+      lanes[count] = {first, root_, nullptr};
+    }
+    prefetch_line(root_);
+    bool active = root_ != nullptr;
+    while (active) {
+      active = false;
+      for (size_t i = 0; i < count; ++i) {
+        lane& walk = lanes[i];
+        if (walk.current == nullptr) continue;
+        if (compare_(*walk.key, walk.current->data_)) {
+          walk.current = walk.current->left_;
+        } else if (compare_(walk.current->data_, *walk.key)) {
+          walk.current = walk.current->right_;
+        } else {
+          walk.found = walk.current;
+          walk.current = nullptr;
+        }
+        if (walk.current != nullptr) {
+          prefetch_line(walk.current);
+          active = true;
+        }
+      }
+    }
+    for (size_t i = 0; i < count; ++i) {
+      emit(lanes[i].found);
+    }
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename key_type>
+typename s21::rb_tree<data_type, compare, allocator, options>::node*
+s21::rb_tree<data_type, compare, allocator, options>::lower_bound_node(
+    const key_type& key) const {
+  node* current = root_;
+  node* result = nullptr;
+  while (current != nullptr) {
+    prefetch_children(current);
+    if (!compare_(current->data_, key)) {
+      result = current;
+      current = current->left_;
+    } else {
+      current = current->right_;
     }
   }
-  return cend();
+  return result;
 }
 
-template <typename data_type, typename compare>
-void s21::rb_tree<data_type, compare>::clear() {
-  while (root_ != nullptr) {
-    erase(iterator(root_, this));
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename key_type>
+typename s21::rb_tree<data_type, compare, allocator, options>::node*
+s21::rb_tree<data_type, compare, allocator, options>::upper_bound_node(
+    const key_type& key) const {
+  node* current = root_;
+  node* result = nullptr;
+  while (current != nullptr) {
+    prefetch_children(current);
+    if (compare_(key, current->data_)) {
+      result = current;
+      current = current->left_;
+    } else {
+      current = current->right_;
+    }
   }
-  this->size_ = 0;
+  return result;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::clear() {
+  destroy_tree(root_);
+  root_ = nullptr;
+  leftmost_ = nullptr;
+  rightmost_ = nullptr;
+  size_ = 0;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+std::pair<typename s21::rb_tree<data_type, compare, allocator,
+                                options>::iterator, bool>
+s21::rb_tree<data_type, compare, allocator, options>::insert_data(
+    const data_type& data) {
+  if (allows_duplicates()) return {insert_equal(data), true};
+  return insert_unique(data);
 }
 
-template <typename data_type, typename compare>
-std::pair<typename s21::rb_tree<data_type, compare>::iterator, bool>
-s21::rb_tree<data_type, compare>::insert_data(const data_type& data) {
+// Место ищется до создания узла: если ключ уже есть, значение не
+// копируется и не перемещается.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename value_type>
+std::pair<typename s21::rb_tree<data_type, compare, allocator,
+                                options>::iterator, bool>
+s21::rb_tree<data_type, compare, allocator, options>::insert_unique(
+    value_type&& data) {
   node* current_node = root_;
   node* parent_node = nullptr;
+  bool as_left = false;
   while (current_node != nullptr) {
     parent_node = current_node;
+    prefetch_children(current_node);
     if (compare_(data, current_node->data_)) {
       current_node = current_node->left_;
+      as_left = true;
     } else if (compare_(current_node->data_, data)) {
       current_node = current_node->right_;
+      as_left = false;
     } else {
       return std::make_pair(iterator(current_node, this), false);
     }
   }
-  node* new_node = new node(data, nullptr);
-  new_node->parent_ = parent_node;
-  if (parent_node == nullptr) {
-    root_ = new_node;
-  } else if (!compare_(data, parent_node->data_)) {
-    parent_node->right_ = new_node;
-  } else {
-    parent_node->left_ = new_node;
+  node* new_node = create_node(parent_node, std::forward<value_type>(data));
+  link_node(new_node, parent_node, as_left);
+  return std::make_pair(iterator(new_node, this), true);
+}
+
+// Узел с уже построенным значением; если такой ключ есть, узел не
+// вставляется и остается на ответственности вызывающего. Дубликат
+// в мультимножестве встает после равных.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+std::pair<typename s21::rb_tree<data_type, compare, allocator,
+                                options>::iterator, bool>
+s21::rb_tree<data_type, compare, allocator, options>::insert_node(
+    node* new_node) {
+  node* current_node = root_;
+  node* parent_node = nullptr;
+  bool as_left = false;
+  bool duplicates = allows_duplicates();
+  while (current_node != nullptr) {
+    parent_node = current_node;
+    prefetch_children(current_node);
+    if (duplicates) {
+      as_left = compare_(new_node->data_, current_node->data_);
+      current_node = as_left ? current_node->left_ : current_node->right_;
+    } else if (compare_(new_node->data_, current_node->data_)) {
+      current_node = current_node->left_;
+      as_left = true;
+    } else if (compare_(current_node->data_, new_node->data_)) {
+      current_node = current_node->right_;
+      as_left = false;
+    } else {
+      return std::make_pair(iterator(current_node, this), false);
+    }
   }
-  fix_violation(new_node);
-  ++size_;
+  link_node(new_node, parent_node, as_left);
   return std::make_pair(iterator(new_node, this), true);
 }
 
-template <typename data_type, typename compare>
-void s21::rb_tree<data_type, compare>::erase(iterator pos) {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename... Args>
+std::pair<typename s21::rb_tree<data_type, compare, allocator,
+                                options>::iterator, bool>
+s21::rb_tree<data_type, compare, allocator, options>::emplace_data(
+    Args&&... args) {
+  node* new_node = create_node(nullptr, std::forward<Args>(args)...);
+  std::pair<iterator, bool> result = insert_node(new_node);
+  if (!result.second) {
+    destroy_node(new_node);
+  }
+  return result;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename value_type>
+typename s21::rb_tree<data_type, compare, allocator, options>::iterator
+s21::rb_tree<data_type, compare, allocator, options>::insert_hint(
+    iterator hint, value_type&& data) {
+  node* position = nullptr;
+  bool as_left = false;
+  hint_result result = check_hint(hint, data, position, as_left);
+  if (result == hint_result::equal) {
+    return iterator(position, this);
+  }
+  if (result == hint_result::miss) {
+    if (allows_duplicates()) {
+      return insert_equal(std::forward<value_type>(data));
+    }
+    return insert_unique(std::forward<value_type>(data)).first;
+  }
+  node* new_node = create_node(position, std::forward<value_type>(data));
+  link_node(new_node, position, as_left);
+  return iterator(new_node, this);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::iterator
+s21::rb_tree<data_type, compare, allocator, options>::insert_node_hint(
+    iterator hint, node* new_node) {
+  node* position = nullptr;
+  bool as_left = false;
+  hint_result result = check_hint(hint, new_node->data_, position, as_left);
+  if (result == hint_result::fits) {
+    link_node(new_node, position, as_left);
+    return iterator(new_node, this);
+  }
+  if (result == hint_result::miss) {
+    std::pair<iterator, bool> inserted = insert_node(new_node);
+    if (inserted.second) return inserted.first;
+    position = inserted.first.get_node();
+  }
+  destroy_node(new_node);
+  return iterator(position, this);
+}
+
+// Если значение встает непосредственно перед hint, узел подвешивается
+// рядом с hint без спуска от корня (fits). equal - ключ уже есть
+// в соседнем узле, miss - hint не подходит и нужна обычная вставка.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::hint_result
+s21::rb_tree<data_type, compare, allocator, options>::check_hint(
+    iterator hint, const data_type& data, node*& position, bool& as_left) {
+  node* next = hint.get_node();
+  node* prev = nullptr;
+  if (next == nullptr) {
+    prev = rightmost_;
+  } else if (next->left_ != nullptr) {
+    prev = max_node(next->left_);
+  } else {
+    iterator before = hint;
+    prev = (--before).get_node();
+  }
+  bool duplicates = allows_duplicates();
+  bool before_next = next == nullptr ||
+                     (duplicates ? !compare_(next->data_, data)
+                                 : compare_(data, next->data_));
+  bool after_prev = prev == nullptr ||
+                    (duplicates ? !compare_(data, prev->data_)
+                                : compare_(prev->data_, data));
+  if (!duplicates && next != nullptr && !before_next &&
+      !compare_(next->data_, data)) {
+    position = next;
+    return hint_result::equal;
+  }
+  if (!duplicates && prev != nullptr && before_next && !after_prev &&
+      !compare_(data, prev->data_)) {
+    position = prev;
+    return hint_result::equal;
+  }
+  if (!before_next || !after_prev) {
+    return hint_result::miss;
+  }
+  as_left = next != nullptr && next->left_ == nullptr;
+  position = as_left ? next : prev;
+  return hint_result::fits;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::erase(iterator pos) {
   node* node_to_delete = pos.get_node();
   if (!node_to_delete) return;
-  node* replacement_node = node_to_delete;
-  node* child_node = nullptr;
-  if (node_to_delete->left_ && node_to_delete->right_) {
-    replacement_node = min_node(node_to_delete->right_);
+  unlink_node(node_to_delete);
+  destroy_node(node_to_delete);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::iterator
+s21::rb_tree<data_type, compare, allocator, options>::erase(iterator first,
+                                                             iterator last) {
+  erase_range(first, last);
+  return last;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+size_t s21::rb_tree<data_type, compare, allocator, options>::erase(
+    const data_type& value) {
+  if (!allows_duplicates()) {
+    node* node_curr = find_node(value);
+    if (!node_curr) return 0;
+    erase(iterator(node_curr, this));
+    return 1;
   }
-  if (replacement_node->left_) {
-    child_node = replacement_node->left_;
-  } else {
-    child_node = replacement_node->right_;
+  std::pair<iterator, iterator> range = equal_range(value);
+  return erase_range(range.first, range.second);
+}
+
+// Небольшой диапазон удаляется поэлементно, большой - перестройкой дерева
+// из оставшихся узлов вместо k отдельных балансировок.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+size_t s21::rb_tree<data_type, compare, allocator, options>::erase_range(
+    iterator first, iterator last) {
+  size_t count = 0;
+  for (iterator it = first; it != last; ++it) ++count;
+  if (count == 0) return 0;
+  if (!prefers_rebuild(count, size_)) {
+    while (first != last) erase(first++);
+    return count;
   }
-  if (child_node) {
-    child_node->parent_ = replacement_node->parent_;
+  std::vector<node*> kept;
+  std::vector<node*> removed;
+  kept.reserve(size_ - count);
+  removed.reserve(count);
+  bool inside = false;
+  for (node* node_curr = leftmost_; node_curr != nullptr;
+       node_curr = next_node(node_curr)) {
+    if (node_curr == first.get_node()) inside = true;
+    if (node_curr == last.get_node()) inside = false;
+    (inside ? removed : kept).push_back(node_curr);
   }
-  if (!replacement_node->parent_) {
-    root_ = child_node;
-  } else if (replacement_node == replacement_node->parent_->left_) {
-    replacement_node->parent_->left_ = child_node;
+  for (node* node_curr : removed) destroy_node(node_curr);
+  rebuild_from(kept);
+  return count;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename predicate>
+size_t s21::rb_tree<data_type, compare, allocator, options>::erase_if(
+    predicate pred) {
+  std::vector<node*> kept;
+  std::vector<node*> removed;
+  for (node* node_curr = leftmost_; node_curr != nullptr;
+       node_curr = next_node(node_curr)) {
+    const data_type& data = node_curr->data_;
+    (pred(data) ? removed : kept).push_back(node_curr);
+  }
+  if (!prefers_rebuild(removed.size(), size_)) {
+    for (node* node_curr : removed) {
+      unlink_node(node_curr);
+      destroy_node(node_curr);
+    }
   } else {
-    replacement_node->parent_->right_ = child_node;
+    for (node* node_curr : removed) destroy_node(node_curr);
+    rebuild_from(kept);
   }
-  if (replacement_node != node_to_delete) {
-    node_to_delete->data_ = replacement_node->data_;
+  return removed.size();
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::node_handle
+s21::rb_tree<data_type, compare, allocator, options>::extract(iterator pos) {
+  node* node_curr = pos.get_node();
+  if (!node_curr) return node_handle();
+  unlink_node(node_curr);
+  return node_handle(node_curr, node_alloc_);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator,
+                      options>::insert_return_type
+s21::rb_tree<data_type, compare, allocator, options>::insert_handle(
+    node_handle&& handle) {
+  if (handle.empty()) return {end(), false, node_handle()};
+  std::pair<iterator, bool> result;
+  if (*handle.alloc_ == node_alloc_) {
+    // тот же пул: узел перевешивается без выделения памяти
+    node* node_curr = handle.ptr_;
+    reset_node(node_curr);
+    result = insert_node(node_curr);
+    if (result.second) handle.release();
+  } else if (allows_duplicates()) {
+    result = insert_node(create_node(nullptr, std::move(handle.value())));
+  } else {
+    result = insert_unique(std::move(handle.value()));
   }
+  if (!result.second) return {result.first, false, std::move(handle)};
+  handle.reset();
+  return {result.first, true, node_handle()};
+}
 
-  if (replacement_node->color_ == black && child_node) {
-    delete_fix(child_node);
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::replace_child(
+    node* old_child, node* new_child) noexcept {
+  node* parent = old_child->parent();
+  if (!parent) {
+    root_ = new_child;
+  } else if (parent->left_ == old_child) {
+    parent->left_ = new_child;
+  } else {
+    parent->right_ = new_child;
   }
-  delete replacement_node;
+  if (new_child) new_child->set_parent(parent);
+}
+
+// Узел вынимается из дерева перевешиванием указателей: при двух потомках
+// на его место встает преемник, данные никуда не копируются, поэтому
+// итераторы на остальные элементы остаются действительными.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::unlink_node(
+    node* node_curr) noexcept {
+  if (node_curr == leftmost_) {
+    leftmost_ = node_curr->right_ ? min_node(node_curr->right_)
+                                  : node_curr->parent();
+  }
+  if (node_curr == rightmost_) {
+    rightmost_ = node_curr->left_ ? max_node(node_curr->left_)
+                                  : node_curr->parent();
+  }
+  node* child = nullptr;
+  node* child_parent = nullptr;
+  color_node removed_color = node_curr->color();
+  if (!node_curr->left_ || !node_curr->right_) {
+    child = node_curr->left_ ? node_curr->left_ : node_curr->right_;
+    child_parent = node_curr->parent();
+    replace_child(node_curr, child);
+  } else {
+    node* successor = min_node(node_curr->right_);
+    removed_color = successor->color();
+    child = successor->right_;
+    if (successor == node_curr->right_) {
+      child_parent = successor;
+    } else {
+      child_parent = successor->parent();
+      replace_child(successor, child);
+      successor->right_ = node_curr->right_;
+      successor->right_->set_parent(successor);
+    }
+    replace_child(node_curr, successor);
+    successor->left_ = node_curr->left_;
+    successor->left_->set_parent(successor);
+    successor->set_color(node_curr->color());
+  }
+  update_sizes_upward(child_parent);
+  if (removed_color == black) delete_fix(child, child_parent);
   --size_;
 }
 
-template <typename data_type, typename compare>
-void s21::rb_tree<data_type, compare>::swap(rb_tree& other) noexcept {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::swap(
+    rb_tree& other) noexcept {
   std::swap(root_, other.root_);
   std::swap(size_, other.size_);
+  std::swap(leftmost_, other.leftmost_);
+  std::swap(rightmost_, other.rightmost_);
   std::swap(compare_, other.compare_);
+  std::swap(node_alloc_, other.node_alloc_);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void
+s21::rb_tree<data_type, compare, allocator, options>::merge(rb_tree& other) {
+  if (this == &other || other.empty()) return;
+  if (node_alloc_ != other.node_alloc_) {
+    // узлы из чужого пула переехать не могут, переносим только значения
+    for (node* node_curr = other.leftmost_; node_curr != nullptr;) {
+      node* next = next_node(node_curr);
+      if (allows_duplicates()) {
+        insert_node(create_node(nullptr, std::move(node_curr->data_)));
+        other.erase(iterator(node_curr, &other));
+      } else if (!find_node(node_curr->data_)) {
+        insert_unique(std::move(node_curr->data_));
+        other.erase(iterator(node_curr, &other));
+      }
+      node_curr = next;
+    }
+  } else if (prefers_rebuild(other.size_, size_ + other.size_)) {
+    merge_linear(other);
+  } else {
+    for (node* node_curr = other.leftmost_; node_curr != nullptr;) {
+      node* next = next_node(node_curr);
+      if (allows_duplicates() || !find_node(node_curr->data_)) {
+        other.unlink_node(node_curr);
+        reset_node(node_curr);
+        insert_node(node_curr);
+      }
+      node_curr = next;
+    }
+  }
+}
+
+// batch поэлементных вставок или удалений стоит O(batch log total),
+// перестройка дерева из упорядоченного списка узлов - O(total).
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+bool s21::rb_tree<data_type, compare, allocator, options>::prefers_rebuild(
+    size_t batch, size_t total) noexcept {
+  size_t height = 1;
+  while ((size_t(1) << height) < total) ++height;
+  return batch * height >= total;
 }
 
-template <typename data_type, typename compare>
-void s21::rb_tree<data_type, compare>::merge(rb_tree& other) {
-  if (this == &other) return;
-  for (auto it = other.begin(); it != other.end(); ++it) {
-    insert_data(*it);
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::rebuild_from(
+    const std::vector<node*>& nodes, execution policy) {
+  size_t chunks = chunk_count(nodes.size(), policy);
+  if (chunks == 1) {
+    auto it = nodes.cbegin();
+    auto next = [&it] { return *it++; };
+    build_root(next, nodes.size());
+    return;
   }
-  other.clear();
+  // поддеревья на глубине cut_depth не пересекаются и собираются
+  // задачами пула, верхние уровни затем связываются в одном потоке
+  build_plan plan{nodes, 0, 0, {}, {}, 0};
+  while ((size_t(2) << plan.red_depth) <= nodes.size()) ++plan.red_depth;
+  while ((size_t(1) << plan.cut_depth) < chunks) ++plan.cut_depth;
+  collect_slices(plan, 0, nodes.size(), 0);
+  plan.subtrees.resize(plan.slices.size());
+  for_each_chunk(plan.slices.size(), policy, [this, &plan](size_t index) {
+    auto it = plan.nodes.cbegin() + plan.slices[index].first;
+    auto next = [&it] { return *it++; };
+    plan.subtrees[index] = build_sorted(next, plan.slices[index].second,
+                                        plan.cut_depth, plan.red_depth);
+  });
+  root_ = link_slices(plan, 0, nodes.size(), 0);
+  root_->set_parent(nullptr);
+  root_->set_color(black);
+  size_ = nodes.size();
+  reset_extremes();
 }
 
-template <typename data_type, typename compare>
-typename s21::rb_tree<data_type, compare>::node*
-s21::rb_tree<data_type, compare>::copy_tree(node* src) {
-  if (src == nullptr) {
-    return nullptr;
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::collect_slices(
+    build_plan& plan, size_t first, size_t count, size_t depth) {
+  if (count == 0) return;
+  if (depth == plan.cut_depth) {
+    plan.slices.emplace_back(first, count);
+    return;
   }
-  std::stack<node*> src_stack, copy_stack;
-  src_stack.push(src);
-  node* new_root = new node(src->data_, nullptr);
-  copy_stack.push(new_root);
-  while (!src_stack.empty()) {
-    node* src_node = src_stack.top();
-    node* copy_node = copy_stack.top();
-    src_stack.pop();
-    copy_stack.pop();
-    if (src_node->right_ != nullptr) {
-      copy_node->right_ = new node(src_node->right_->data_, copy_node);
-      copy_stack.push(copy_node->right_);
-      src_stack.push(src_node->right_);
+  size_t left_count = count / 2;
+  collect_slices(plan, first, left_count, depth + 1);
+  collect_slices(plan, first + left_count + 1, count - left_count - 1,
+                 depth + 1);
+}
+
+// Повторяет обход build_sorted, подставляя готовые поддеревья
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::node*
+s21::rb_tree<data_type, compare, allocator, options>::link_slices(
+    build_plan& plan, size_t first, size_t count, size_t depth) {
+  if (count == 0) return nullptr;
+  if (depth == plan.cut_depth) return plan.subtrees[plan.next_subtree++];
+  size_t left_count = count / 2;
+  node* left = link_slices(plan, first, left_count, depth + 1);
+  node* current = plan.nodes[first + left_count];
+  current->set_color(depth == plan.red_depth ? red : black);
+  current->left_ = left;
+  if (left) left->set_parent(current);
+  current->right_ = link_slices(plan, first + left_count + 1,
+                                count - left_count - 1, depth + 1);
+  if (current->right_) current->right_->set_parent(current);
+  update_size(current);
+  return current;
+}
+
+// Слияние без выделения памяти под элементы: узлы обоих деревьев
+// сливаются в один упорядоченный список и перевешиваются в новое дерево.
+// Дубликаты при уникальных ключах остаются в other.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::merge_linear(
+    rb_tree& other) {
+  std::vector<node*> merged;
+  std::vector<node*> rest;
+  merged.reserve(size_ + other.size_);
+  node* left = leftmost_;
+  node* right = other.leftmost_;
+  while (left != nullptr && right != nullptr) {
+    if (compare_(right->data_, left->data_)) {
+      merged.push_back(right);
+      right = next_node(right);
+    } else if (!allows_duplicates() && !compare_(left->data_, right->data_)) {
+      rest.push_back(right);
+      right = next_node(right);
+    } else {
+      merged.push_back(left);
+      left = next_node(left);
     }
-    if (src_node->left_ != nullptr) {
-      copy_node->left_ = new node(src_node->left_->data_, copy_node);
-      copy_stack.push(copy_node->left_);
-      src_stack.push(src_node->left_);
+  }
+  for (; left != nullptr; left = next_node(left)) merged.push_back(left);
+  for (; right != nullptr; right = next_node(right)) merged.push_back(right);
+
+  rebuild_from(merged);
+  other.rebuild_from(rest);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::join(
+    const data_type& pivot, rb_tree& right) {
+  if (this == &right || (!empty() && !in_order(back(), pivot)) ||
+      (!right.empty() && !in_order(pivot, right.front()))) {
+    throw std::invalid_argument("rb_tree::join: keys are out of order");
+  }
+  join_node(create_node(nullptr, pivot), right);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::join(
+    rb_tree& right) {
+  if (this == &right || right.empty()) return;
+  if (!empty() && !in_order(back(), right.front())) {
+    throw std::invalid_argument("rb_tree::join: keys are out of order");
+  }
+  node* pivot = right.leftmost_;
+  if (node_alloc_ != right.node_alloc_) {
+    pivot = create_node(nullptr, std::move(pivot->data_));
+    right.erase(right.begin());
+  } else {
+    right.unlink_node(pivot);
+  }
+  join_node(pivot, right);
+}
+
+// Склейка за O(|h1 - h2| + 1) по черным высотам. Узлы из чужого пула
+// перевесить нельзя, тогда значения дописываются в конец по одному.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::join_node(
+    node* pivot, rb_tree& right) {
+  if (node_alloc_ != right.node_alloc_) {
+    insert_node_hint(end(), pivot);
+    for (node* node_curr = right.leftmost_; node_curr != nullptr;
+         node_curr = next_node(node_curr)) {
+      insert_hint(end(), std::move(node_curr->data_));
     }
+    right.clear();
+    return;
   }
-  return new_root;
+  size_t left_height = blacken_root(root_);
+  size_t right_height = blacken_root(right.root_);
+  root_ = join_nodes(root_, left_height, pivot, right.root_, right_height)
+              .first;
+  size_ += right.size_ + 1;
+  if (leftmost_ == nullptr) leftmost_ = pivot;
+  rightmost_ = right.rightmost_ ? right.rightmost_ : pivot;
+  right.root_ = nullptr;
+  right.size_ = 0;
+  right.leftmost_ = nullptr;
+  right.rightmost_ = nullptr;
 }
 
-template <typename data_type, typename compare>  // ++
-typename s21::rb_tree<data_type, compare>::iterator
-s21::rb_tree<data_type, compare>::find(const data_type& value) {
-  node* current = root_;
-  while (current != nullptr) {
-    if (compare_(value, current->data_)) {
-      current = current->left_;
-    } else if (compare_(current->data_, value)) {
-      current = current->right_;
+// Корни left и right черные, их родители обнулены. Если высоты равны,
+// pivot становится черным корнем. Иначе он красным встает на спуске по
+// краю высокого дерева вместо черного узла нужной высоты, и нарушение
+// чинится как после вставки. root_ служит рабочим корнем.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+std::pair<typename s21::rb_tree<data_type, compare, allocator,
+                                options>::node*, size_t>
+s21::rb_tree<data_type, compare, allocator, options>::join_nodes(
+    node* left, size_t left_height, node* pivot, node* right,
+    size_t right_height) {
+  if (left_height == right_height) {
+    pivot->left_ = left;
+    pivot->right_ = right;
+    if (left) left->set_parent(pivot);
+    if (right) right->set_parent(pivot);
+    pivot->set_parent(nullptr);
+    pivot->set_color(black);
+    update_size(pivot);
+    return {pivot, left_height + 1};
+  }
+  bool left_taller = left_height > right_height;
+  node* spine = left_taller ? left : right;
+  size_t height = left_taller ? left_height : right_height;
+  size_t target = left_taller ? right_height : left_height;
+  size_t added = subtree_size(left_taller ? right : left) + 1;
+  node* parent = nullptr;
+  while (height > target || !is_black(spine)) {
+    if (spine->color() == black) --height;
+    if constexpr (options::order_statistics) {
+      spine->subtree_size_ += added;
+    }
+    parent = spine;
+    spine = left_taller ? spine->right_ : spine->left_;
+  }
+  if (left_taller) {
+    pivot->left_ = spine;
+    pivot->right_ = right;
+    parent->right_ = pivot;
+  } else {
+    pivot->left_ = left;
+    pivot->right_ = spine;
+    parent->left_ = pivot;
+  }
+  if (pivot->left_) pivot->left_->set_parent(pivot);
+  if (pivot->right_) pivot->right_->set_parent(pivot);
+  pivot->set_parent(parent);
+  pivot->set_color(red);
+  update_size(pivot);
+  root_ = left_taller ? left : right;
+  bool grown = fix_violation(pivot);
+  return {root_, (left_taller ? left_height : right_height) + grown};
+}
+
+// Перекрашивает корень в черный и возвращает черную высоту дерева
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+size_t s21::rb_tree<data_type, compare, allocator, options>::blacken_root(
+    node* root) noexcept {
+  if (root == nullptr) return 0;
+  root->set_color(black);
+  size_t height = 0;
+  for (node* node_curr = root; node_curr; node_curr = node_curr->left_) {
+    if (node_curr->color() == black) ++height;
+  }
+  return height;
+}
+
+// Элементы меньше key остаются в дереве, остальные переезжают в пустое
+// right с тем же аллокатором. Разрезание идет одним спуском и стоит
+// O(log n). Без order_statistics размеры частей считаются встречным
+// обходом за O(min(k, n - k)).
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename key_type>
+void s21::rb_tree<data_type, compare, allocator, options>::split_into(
+    const key_type& key, rb_tree& right) {
+  if (node_alloc_ != right.node_alloc_) {
+    // узлы чужого пула не перевешиваются: хвост отделяется в дерево на
+    // нашем пуле и переносится в right поэлементно
+    rb_tree tail;
+    tail.compare_ = compare_;
+    tail.node_alloc_ = node_alloc_;
+    split_into(key, tail);
+    right.clear();
+    node* source = tail.leftmost_;
+    auto next = [&right, &source] {
+      node* new_node = right.create_node(nullptr, std::move(source->data_));
+      source = next_node(source);
+      return new_node;
+    };
+    right.build_root(next, tail.size_);
+    return;
+  }
+  size_t total = size_;
+  split_parts parts = split_nodes(root_, blacken_root(root_), key);
+  root_ = parts.left;
+  right.root_ = parts.right;
+  reset_extremes();
+  right.reset_extremes();
+  if constexpr (options::order_statistics) {
+    size_ = subtree_size(root_);
+  } else {
+    size_t steps = 0;
+    node* lower = leftmost_;
+    node* upper = right.leftmost_;
+    while (lower != nullptr && upper != nullptr) {
+      lower = next_node(lower);
+      upper = next_node(upper);
+      ++steps;
+    }
+    size_ = lower == nullptr ? steps : total - steps;
+  }
+  right.size_ = total - size_;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename key_type>
+typename s21::rb_tree<data_type, compare, allocator, options>::split_parts
+s21::rb_tree<data_type, compare, allocator, options>::split_nodes(
+    node* root, size_t height, const key_type& key) {
+  if (root == nullptr) return {nullptr, 0, nullptr, 0};
+  node* left = root->left_;
+  node* right = root->right_;
+  size_t left_height = height - 1;
+  size_t right_height = height - 1;
+  if (left) {
+    left->set_parent(nullptr);
+    if (left->color() == red) {
+      left->set_color(black);
+      left_height = height;
+    }
+  }
+  if (right) {
+    right->set_parent(nullptr);
+    if (right->color() == red) {
+      right->set_color(black);
+      right_height = height;
+    }
+  }
+  if (compare_(root->data_, key)) {
+    split_parts parts = split_nodes(right, right_height, key);
+    auto joined =
+        join_nodes(left, left_height, root, parts.left, parts.left_height);
+    return {joined.first, joined.second, parts.right, parts.right_height};
+  }
+  split_parts parts = split_nodes(left, left_height, key);
+  auto joined =
+      join_nodes(parts.right, parts.right_height, root, right, right_height);
+  return {parts.left, parts.left_height, joined.first, joined.second};
+}
+
+// Слияние двух упорядоченных обходов с копированием нужных элементов и
+// сборкой дерева за O(n + m). Если из rhs в результат ничего не попадает,
+// а rhs намного больше lhs, курсор по rhs не шагает, а прыгает поиском
+// нижней границы: O(m log n) вместо O(n + m). Объединение множеств с
+// намного меньшим деревом идет через assign_skewed_union.
+// В параллельном режиме оба дерева режутся по ключам верхних уровней
+// большего дерева, и части сливаются независимо.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::assign_set_operation(
+    const rb_tree& lhs, const rb_tree& rhs, set_operation operation,
+    execution policy) {
+  if (operation == set_operation::intersect && lhs.size_ > rhs.size_) {
+    assign_set_operation(rhs, lhs, operation, policy);
+    return;
+  }
+  bool keep_right = operation == set_operation::unite ||
+                    operation == set_operation::symmetric;
+  if (operation == set_operation::unite && !allows_duplicates() &&
+      !prefers_rebuild(std::min(lhs.size_, rhs.size_),
+                       lhs.size_ + rhs.size_)) {
+    assign_skewed_union(lhs, rhs, policy);
+    return;
+  }
+  bool gallop =
+      !keep_right && !prefers_rebuild(lhs.size_, lhs.size_ + rhs.size_);
+  const rb_tree& larger = lhs.size_ < rhs.size_ ? rhs : lhs;
+  std::vector<const data_type*> keys =
+      larger.splitters(chunk_count(lhs.size_ + rhs.size_, policy));
+
+  merge_chunks chunks(keys.size() + 1);
+  for_each_chunk(chunks.size(), policy, [&](size_t index) {
+    node* left = index == 0 ? lhs.leftmost_
+                            : lhs.lower_bound_node(*keys[index - 1]);
+    node* right = index == 0 ? rhs.leftmost_
+                             : rhs.lower_bound_node(*keys[index - 1]);
+    node* left_end = nullptr;
+    node* right_end = nullptr;
+    if (index < keys.size()) {
+      left_end = lhs.lower_bound_node(*keys[index]);
+      right_end = rhs.lower_bound_node(*keys[index]);
+    }
+    merge_ranges(left, left_end, rhs, right, right_end, operation, gallop,
+                 chunks[index]);
+  });
+  std::vector<node*> nodes = materialize(chunks, policy);
+  clear();
+  rebuild_from(nodes, policy);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::merge_ranges(
+    node* left, node* left_end, const rb_tree& rhs, node* right,
+    node* right_end, set_operation operation, bool gallop,
+    std::vector<merge_item>& out) const {
+  bool keep_left = operation != set_operation::intersect;
+  bool keep_right = operation == set_operation::unite ||
+                    operation == set_operation::symmetric;
+  bool keep_common = operation == set_operation::unite ||
+                     operation == set_operation::intersect;
+  while (left != left_end && right != right_end) {
+    if (compare_(left->data_, right->data_)) {
+      if (keep_left) out.push_back({nullptr, &left->data_});
+      left = next_node(left);
+    } else if (compare_(right->data_, left->data_)) {
+      if (keep_right) out.push_back({nullptr, &right->data_});
+      right = gallop ? rhs.lower_bound_node(left->data_) : next_node(right);
     } else {
-      return iterator(current, this);
+      if (keep_common) out.push_back({nullptr, &left->data_});
+      left = next_node(left);
+      right = next_node(right);
     }
   }
-  return end();
+  for (; keep_left && left != left_end; left = next_node(left)) {
+    out.push_back({nullptr, &left->data_});
+  }
+  for (; keep_right && right != right_end; right = next_node(right)) {
+    out.push_back({nullptr, &right->data_});
+  }
 }
 
-template <typename data_type, typename compare>
-typename s21::rb_tree<data_type, compare>::node*
-s21::rb_tree<data_type, compare>::max_node(node* node_curr) const {
+// Узлы дерева идут раньше равных значений пакета; при уникальных ключах
+// значения, равные уже выданному элементу, пропускаются.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename batch_iterator>
+void s21::rb_tree<data_type, compare, allocator, options>::merge_batch(
+    node* tree_first, node* tree_last, batch_iterator first,
+    batch_iterator last, std::vector<merge_item>& out) const {
+  bool unique = !allows_duplicates();
+  const data_type* previous = nullptr;
+  while (tree_first != tree_last || first != last) {
+    if (first == last || (tree_first != tree_last &&
+                          !compare_(*first, tree_first->data_))) {
+      out.push_back({tree_first, nullptr});
+      previous = &tree_first->data_;
+      tree_first = next_node(tree_first);
+    } else {
+      if (!unique || previous == nullptr || compare_(*previous, *first)) {
+        out.push_back({nullptr, &*first});
+        previous = &*first;
+      }
+      ++first;
+    }
+  }
+}
+
+// Память под новые узлы выделяется в одном потоке: параллельные выделения
+// сходились бы на замке пула и перемешивали блоки резерва. Копирование
+// значений идет по частям параллельно.
+// При исключении все новые узлы освобождаются, готовые узлы не трогаются.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+std::vector<typename s21::rb_tree<data_type, compare, allocator,
+                                  options>::node*>
+s21::rb_tree<data_type, compare, allocator, options>::materialize(
+    const merge_chunks& chunks, execution policy) {
+  std::vector<size_t> offsets(chunks.size() + 1, 0);
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    offsets[i + 1] = offsets[i] + chunks[i].size();
+  }
+  std::vector<node*> nodes(offsets.back(), nullptr);
+  std::vector<size_t> built(chunks.size(), 0);
+  size_t fresh = 0;
+  for (const std::vector<merge_item>& chunk : chunks) {
+    for (const merge_item& item : chunk) fresh += item.existing ? 0 : 1;
+  }
+  reserve_nodes(fresh);
+  try {
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      for (size_t j = 0; j < chunks[i].size(); ++j) {
+        const merge_item& item = chunks[i][j];
+        nodes[offsets[i] + j] = item.existing
+                                    ? item.existing
+                                    : node_traits::allocate(node_alloc_, 1);
+      }
+    }
+    for_each_chunk(chunks.size(), policy, [&](size_t index) {
+      for (size_t j = 0; j < chunks[index].size(); ++j) {
+        const merge_item& item = chunks[index][j];
+        if (item.existing) continue;
+        node_traits::construct(node_alloc_, nodes[offsets[index] + j],
+                               nullptr, *item.value);
+        ++built[index];
+      }
+    });
+  } catch (...) {
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      for (size_t j = 0; j < chunks[i].size(); ++j) {
+        node* node_curr = nodes[offsets[i] + j];
+        if (chunks[i][j].existing || node_curr == nullptr) continue;
+        if (built[i] > 0) {
+          node_traits::destroy(node_alloc_, node_curr);
+          --built[i];
+        }
+        node_traits::deallocate(node_alloc_, node_curr, 1);
+      }
+    }
+    throw;
+  }
+  return nodes;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+size_t s21::rb_tree<data_type, compare, allocator, options>::chunk_count(
+    size_t total, execution policy) {
+  if (policy == execution::sequential || total < parallel_threshold ||
+      thread_pool::inside_task()) {
+    return 1;
+  }
+  return thread_pool::shared().concurrency() * 4;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename function>
+void s21::rb_tree<data_type, compare, allocator, options>::for_each_chunk(
+    size_t count, execution policy, function&& func) {
+  if (policy == execution::parallel && count > 1) {
+    thread_pool::shared().parallel_for(count, func);
+  } else {
+    for (size_t index = 0; index < count; ++index) func(index);
+  }
+}
+
+// Ключи узлов верхних уровней в порядке обхода делят дерево примерно
+// на chunks равных частей
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+std::vector<const data_type*>
+s21::rb_tree<data_type, compare, allocator, options>::splitters(
+    size_t chunks) const {
+  std::vector<const data_type*> keys;
+  size_t cut = 0;
+  while ((size_t(1) << cut) < chunks) ++cut;
+  collect_keys(root_, 0, cut, keys);
+  return keys;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::collect_keys(
+    const node* node_curr, size_t depth, size_t cut,
+    std::vector<const data_type*>& keys) {
+  if (node_curr == nullptr || depth == cut) return;
+  collect_keys(node_curr->left_, depth + 1, cut, keys);
+  keys.push_back(&node_curr->data_);
+  collect_keys(node_curr->right_, depth + 1, cut, keys);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename input_iterator>
+void s21::rb_tree<data_type, compare, allocator, options>::insert_sorted(
+    input_iterator first, input_iterator last, execution policy) {
+  using category =
+      typename std::iterator_traits<input_iterator>::iterator_category;
+  if constexpr (!std::is_base_of_v<std::random_access_iterator_tag,
+                                   category>) {
+    std::vector<data_type> buffer(first, last);
+    insert_sorted(buffer.cbegin(), buffer.cend(), policy);
+  } else {
+    size_t count = last - first;
+    if (!std::is_sorted(first, last, compare_) ||
+        !prefers_rebuild(count, size_ + count)) {
+      for (; first != last; ++first) insert_data(*first);
+      return;
+    }
+    size_t wanted = chunk_count(size_ + count, policy);
+    std::vector<const data_type*> keys;
+    if (size_ >= count) {
+      keys = splitters(wanted);
+    } else {
+      for (size_t i = 1; i < wanted; ++i) {
+        keys.push_back(&*(first + i * count / wanted));
+      }
+    }
+
+    merge_chunks chunks(keys.size() + 1);
+    for_each_chunk(chunks.size(), policy, [&](size_t index) {
+      node* tree_first = leftmost_;
+      input_iterator batch_first = first;
+      if (index > 0) {
+        tree_first = lower_bound_node(*keys[index - 1]);
+        batch_first = std::lower_bound(first, last, *keys[index - 1],
+                                       compare_);
+      }
+      node* tree_last = nullptr;
+      input_iterator batch_last = last;
+      if (index < keys.size()) {
+        tree_last = lower_bound_node(*keys[index]);
+        batch_last = std::lower_bound(first, last, *keys[index], compare_);
+      }
+      merge_batch(tree_first, tree_last, batch_first, batch_last,
+                  chunks[index]);
+    });
+    rebuild_from(materialize(chunks, policy), policy);
+  }
+}
+
+// Большее дерево копируется структурно, без сравнений, а элементы
+// меньшего вставляются поиском: O(m log n) сравнений вместо O(n + m).
+// Из равных элементов, как и при слиянии, остается элемент lhs.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::assign_skewed_union(
+    const rb_tree& lhs, const rb_tree& rhs, execution policy) {
+  bool lhs_larger = lhs.size_ >= rhs.size_;
+  const rb_tree& larger = lhs_larger ? lhs : rhs;
+  const rb_tree& smaller = lhs_larger ? rhs : lhs;
+  rb_tree result;
+  result.compare_ = compare_;
+  result.node_alloc_ = node_alloc_;
+  result.root_ = result.copy_tree(larger.root_, larger.size_, policy);
+  result.size_ = larger.size_;
+  result.reset_extremes();
+  for (node* item = smaller.leftmost_; item; item = next_node(item)) {
+    auto inserted = result.insert_data(item->data_);
+    if (!inserted.second && !lhs_larger) {
+      result.erase(inserted.first);
+      result.insert_data(item->data_);
+    }
+  }
+  *this = std::move(result);
+}
+
+// Отсортированный вход собирается в сбалансированное дерево за O(n):
+// все уровни, кроме последнего, заполнены и черные, последний - красный.
+// Неотсортированный вход вставляется поэлементно.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename input_iterator>
+void s21::rb_tree<data_type, compare, allocator, options>::assign_sorted(
+    input_iterator first, input_iterator last) {
+  using category =
+      typename std::iterator_traits<input_iterator>::iterator_category;
+  if constexpr (!std::is_base_of_v<std::forward_iterator_tag, category>) {
+    std::vector<data_type> buffer(first, last);
+    assign_sorted(buffer.cbegin(), buffer.cend());
+  } else {
+    clear();
+    if (is_sorted_range(first, last)) {
+      auto next = [this, &first] {
+        node* new_node = create_node(nullptr, *first);
+        ++first;
+        return new_node;
+      };
+      build_root(next, std::distance(first, last));
+    } else {
+      for (; first != last; ++first) {
+        insert_data(*first);
+      }
+    }
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename input_iterator>
+bool s21::rb_tree<data_type, compare, allocator, options>::is_sorted_range(
+    input_iterator first, input_iterator last) const {
+  if (first == last) return true;
+  bool duplicates = allows_duplicates();
+  for (input_iterator next = std::next(first); next != last; ++first, ++next) {
+    if (duplicates ? compare_(*next, *first) : !compare_(*first, *next)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename node_source>
+void s21::rb_tree<data_type, compare, allocator, options>::build_root(
+    node_source& next, size_t count) {
+  size_t red_depth = 0;
+  while ((size_t(2) << red_depth) <= count) ++red_depth;
+  root_ = build_sorted(next, count, 0, red_depth);
+  if (root_) {
+    root_->set_parent(nullptr);
+    root_->set_color(black);
+  }
+  size_ = count;
+  reset_extremes();
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename node_source>
+typename s21::rb_tree<data_type, compare, allocator, options>::node*
+s21::rb_tree<data_type, compare, allocator, options>::build_sorted(
+    node_source& next, size_t count, size_t depth, size_t red_depth) {
+  if (count == 0) return nullptr;
+  size_t left_count = count / 2;
+  node* left = build_sorted(next, left_count, depth + 1, red_depth);
+  node* current = nullptr;
+  try {
+    current = next();
+  } catch (...) {
+    // собранное левое поддерево еще ни к чему не подвешено
+    if (left) left->set_parent(nullptr);
+    destroy_tree(left);
+    throw;
+  }
+  current->set_color(depth == red_depth ? red : black);
+  current->set_parent(nullptr);
+  current->left_ = left;
+  current->right_ = nullptr;
+  if (left) left->set_parent(current);
+  try {
+    current->right_ =
+        build_sorted(next, count - left_count - 1, depth + 1, red_depth);
+  } catch (...) {
+    destroy_tree(current);
+    throw;
+  }
+  if (current->right_) current->right_->set_parent(current);
+  update_size(current);
+  return current;
+}
+
+// Структурная копия: узлы повторяют форму и цвета исходного дерева, так
+// что балансировать нечего, а память под все узлы резервируется одним
+// слэбом. Параллельно копируется только крупное дерево по явному
+// execution::parallel при нескольких ядрах, и не внутри задачи пула
+// (chunk_count): верхние уровни копируются в вызывающем потоке, нижние
+// поддеревья - задачами пула в заранее выделенную память (выделение в
+// одном потоке сохраняет порядок блоков из резерва).
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::node*
+s21::rb_tree<data_type, compare, allocator, options>::copy_tree(
+    const node* src, size_t count, execution policy) {
+  if (src == nullptr) return nullptr;
+  reserve_nodes(count);
+  node* root = nullptr;
+  size_t chunks = chunk_count(count, policy);
+  if (chunks == 1 || thread_pool::shared().concurrency() == 1) {
+    auto make = [this](node* parent, const node* source) {
+      return create_node(parent, source->data_);
+    };
+    try {
+      clone_into(src, nullptr, root, make);
+    } catch (...) {
+      destroy_tree(root);
+      throw;
+    }
+    return root;
+  }
+
+  std::vector<clone_task> tasks;
+  size_t cut = 0;
+  while ((size_t(1) << cut) < chunks) ++cut;
+  try {
+    clone_top(src, nullptr, root, 0, cut, tasks);
+    std::vector<size_t> sizes(tasks.size());
+    for_each_chunk(tasks.size(), execution::parallel,
+                   [&tasks, &sizes](size_t index) {
+                     sizes[index] = count_nodes(tasks[index].source);
+                   });
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      tasks[i].memory.reserve(sizes[i]);
+      while (tasks[i].memory.size() < sizes[i]) {
+        tasks[i].memory.push_back(node_traits::allocate(node_alloc_, 1));
+      }
+    }
+    for_each_chunk(tasks.size(), execution::parallel, [&](size_t index) {
+      clone_task& task = tasks[index];
+      auto make = [this, &task](node* parent, const node* source) {
+        node* new_node = task.memory[task.used];
+        node_traits::construct(node_alloc_, new_node, parent, source->data_);
+        ++task.used;
+        return new_node;
+      };
+      clone_into(task.source, task.parent, *task.slot, make);
+    });
+  } catch (...) {
+    destroy_tree(root);
+    for (clone_task& task : tasks) {
+      for (size_t i = task.used; i < task.memory.size(); ++i) {
+        node_traits::deallocate(node_alloc_, task.memory[i], 1);
+      }
+    }
+    throw;
+  }
+  return root;
+}
+
+// Узел подвешивается к родителю сразу после создания, поэтому при
+// исключении все готовые узлы достижимы из корня копии.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename node_factory>
+void s21::rb_tree<data_type, compare, allocator, options>::clone_into(
+    const node* source, node* parent, node*& slot, node_factory& make) {
+  slot = make(parent, source);
+  slot->set_color(source->color());
+  if constexpr (options::order_statistics) {
+    slot->subtree_size_ = source->subtree_size_;
+  }
+  if (source->left_) clone_into(source->left_, slot, slot->left_, make);
+  if (source->right_) clone_into(source->right_, slot, slot->right_, make);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::clone_top(
+    const node* source, node* parent, node*& slot, size_t depth, size_t cut,
+    std::vector<clone_task>& tasks) {
+  if (depth == cut) {
+    tasks.push_back({source, parent, &slot, {}, 0});
+    return;
+  }
+  slot = create_node(parent, source->data_);
+  slot->set_color(source->color());
+  if constexpr (options::order_statistics) {
+    slot->subtree_size_ = source->subtree_size_;
+  }
+  if (source->left_) {
+    clone_top(source->left_, slot, slot->left_, depth + 1, cut, tasks);
+  }
+  if (source->right_) {
+    clone_top(source->right_, slot, slot->right_, depth + 1, cut, tasks);
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+size_t s21::rb_tree<data_type, compare, allocator, options>::count_nodes(
+    const node* node_curr) noexcept {
+  if constexpr (options::order_statistics) {
+    return subtree_size(node_curr);
+  } else {
+    if (node_curr == nullptr) return 0;
+    return count_nodes(node_curr->left_) + count_nodes(node_curr->right_) + 1;
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::link_node(
+    node* new_node, node* parent, bool as_left) {
+  new_node->set_parent(parent);
+  if (parent == nullptr) {
+    root_ = new_node;
+    leftmost_ = new_node;
+    rightmost_ = new_node;
+  } else if (as_left) {
+    parent->left_ = new_node;
+    if (parent == leftmost_) leftmost_ = new_node;
+  } else {
+    parent->right_ = new_node;
+    if (parent == rightmost_) rightmost_ = new_node;
+  }
+  update_sizes_upward(parent);
+  fix_violation(new_node);
+  ++size_;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename... Args>
+typename s21::rb_tree<data_type, compare, allocator, options>::node*
+s21::rb_tree<data_type, compare, allocator, options>::create_node(
+    node* parent, Args&&... args) {
+  node* new_node = node_traits::allocate(node_alloc_, 1);
+  try {
+    node_traits::construct(node_alloc_, new_node, parent,
+                           std::forward<Args>(args)...);
+  } catch (...) {
+    node_traits::deallocate(node_alloc_, new_node, 1);
+    throw;
+  }
+  return new_node;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::destroy_node(
+    node* node_curr) noexcept {
+  node_traits::destroy(node_alloc_, node_curr);
+  node_traits::deallocate(node_alloc_, node_curr, 1);
+}
+
+// Обход в обратном порядке без стека: спускаемся до листа, удаляем его
+// и возвращаемся к родителю по parent_, каждый узел освобождается один раз.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::destroy_tree(
+    node* node_curr) noexcept {
+  node* stop = node_curr ? node_curr->parent() : nullptr;
+  while (node_curr != stop) {
+    if (node_curr->left_) {
+      node_curr = node_curr->left_;
+    } else if (node_curr->right_) {
+      node_curr = node_curr->right_;
+    } else {
+      node* parent = node_curr->parent();
+      if (parent != stop) {
+        if (parent->left_ == node_curr) {
+          parent->left_ = nullptr;
+        } else {
+          parent->right_ = nullptr;
+        }
+      }
+      destroy_node(node_curr);
+      node_curr = parent;
+    }
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>  // ++
+typename s21::rb_tree<data_type, compare, allocator, options>::iterator
+s21::rb_tree<data_type, compare, allocator, options>::find(
+    const data_type& value) {
+  return iterator(find_node(value), this);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::node*
+s21::rb_tree<data_type, compare, allocator, options>::max_node(
+    node* node_curr) const {
   while (node_curr->right_ != nullptr) {
     node_curr = node_curr->right_;
   }
   return node_curr;
 }
 
-template <typename data_type, typename compare>
-typename s21::rb_tree<data_type, compare>::node*
-s21::rb_tree<data_type, compare>::min_node(node* node_curr) const {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::node*
+s21::rb_tree<data_type, compare, allocator, options>::min_node(
+    node* node_curr) const {
   while (node_curr->left_ != nullptr) {
     node_curr = node_curr->left_;
   }
   return node_curr;
 }
 
-template <typename data_type, typename compare>
-void s21::rb_tree<data_type, compare>::rotate_left(node* node_curr) {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::node*
+s21::rb_tree<data_type, compare, allocator, options>::next_node(
+    node* node_curr) noexcept {
+  node* next = nullptr;
+  if (node_curr->right_ != nullptr) {
+    next = node_curr->right_;
+    while (next->left_ != nullptr) next = next->left_;
+  } else {
+    next = node_curr->parent();
+    while (next != nullptr && node_curr == next->right_) {
+      node_curr = next;
+      next = next->parent();
+    }
+  }
+  prefetch_successor(next);
+  return next;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::rotate_left(
+    node* node_curr) {
   node* right_child = node_curr->right_;
   node_curr->right_ = right_child->left_;
   if (node_curr->right_) {
-    node_curr->right_->parent_ = node_curr;
+    node_curr->right_->set_parent(node_curr);
   }
-  right_child->parent_ = node_curr->parent_;
-  if (!node_curr->parent_) {
+  right_child->set_parent(node_curr->parent());
+  if (!node_curr->parent()) {
     root_ = right_child;
-  } else if (node_curr == node_curr->parent_->left_) {
-    node_curr->parent_->left_ = right_child;
+  } else if (node_curr == node_curr->parent()->left_) {
+    node_curr->parent()->left_ = right_child;
   } else {
-    node_curr->parent_->right_ = right_child;
+    node_curr->parent()->right_ = right_child;
   }
   right_child->left_ = node_curr;
-  node_curr->parent_ = right_child;
+  node_curr->set_parent(right_child);
+  update_size(node_curr);
+  update_size(right_child);
 }
 
-template <typename data_type, typename compare>
-void s21::rb_tree<data_type, compare>::rotate_right(node* node_curr) {
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::rotate_right(
+    node* node_curr) {
   node* left_child = node_curr->left_;
   node_curr->left_ = left_child->right_;
   if (node_curr->left_ != nullptr) {
-    node_curr->left_->parent_ = node_curr;
+    node_curr->left_->set_parent(node_curr);
   }
-  left_child->parent_ = node_curr->parent_;
-  if (node_curr->parent_ == nullptr) {
+  left_child->set_parent(node_curr->parent());
+  if (node_curr->parent() == nullptr) {
     root_ = left_child;
-  } else if (node_curr == node_curr->parent_->left_) {
-    node_curr->parent_->left_ = left_child;
+  } else if (node_curr == node_curr->parent()->left_) {
+    node_curr->parent()->left_ = left_child;
   } else {
-    node_curr->parent_->right_ = left_child;
+    node_curr->parent()->right_ = left_child;
   }
   left_child->right_ = node_curr;
-  node_curr->parent_ = left_child;
+  node_curr->set_parent(left_child);
+  update_size(node_curr);
+  update_size(left_child);
 }
 
-template <typename data_type, typename compare>
-void s21::rb_tree<data_type, compare>::fix_violation(node* node_curr) {
-  while (node_curr != root_ && node_curr->parent_->color_ == red) {
-    node* parent = node_curr->parent_;
-    node* grandparent = parent->parent_;
+// Возвращает true, если черная высота дерева выросла на единицу
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+bool s21::rb_tree<data_type, compare, allocator, options>::fix_violation(
+    node* node_curr) {
+  while (node_curr != root_ && node_curr->parent()->color() == red) {
+    node* parent = node_curr->parent();
+    node* grandparent = parent->parent();
     if (parent == grandparent->left_) {
       node* uncle = grandparent->right_;
-      if (uncle != nullptr && uncle->color_ == red) {
-        grandparent->color_ = red;
-        parent->color_ = black;
-        uncle->color_ = black;
+      if (uncle != nullptr && uncle->color() == red) {
+        grandparent->set_color(red);
+        parent->set_color(black);
+        uncle->set_color(black);
         node_curr = grandparent;
       } else {
         if (node_curr == parent->right_) {
           rotate_left(parent);
           node_curr = parent;
-          parent = node_curr->parent_;
+          parent = node_curr->parent();
         }
         rotate_right(grandparent);
-        std::swap(parent->color_, grandparent->color_);
-        node_curr = parent;
+        parent->set_color(black);
+        grandparent->set_color(red);
+        break;
       }
     } else {
       node* uncle = grandparent->left_;
-      if (uncle != nullptr && uncle->color_ == red) {
-        grandparent->color_ = red;
-        parent->color_ = black;
-        uncle->color_ = black;
+      if (uncle != nullptr && uncle->color() == red) {
+        grandparent->set_color(red);
+        parent->set_color(black);
+        uncle->set_color(black);
         node_curr = grandparent;
       } else {
         if (node_curr == parent->left_) {
           rotate_right(parent);
           node_curr = parent;
-          parent = node_curr->parent_;
+          parent = node_curr->parent();
         }
         rotate_left(grandparent);
-        std::swap(parent->color_, grandparent->color_);
-        node_curr = parent;
+        parent->set_color(black);
+        grandparent->set_color(red);
+        break;
       }
     }
   }
 
-  root_->color_ = black;
+  bool grown = root_->color() == red;
+  root_->set_color(black);
+  return grown;
 }
 
-template <typename data_type, typename compare>
-void s21::rb_tree<data_type, compare>::delete_fix(node* node_curr) {
-  while (node_curr != root_ && node_curr->color_ == black) {
-    if (node_curr == node_curr->parent_->left_) {
-      node* sibling = node_curr->parent_->right_;
-      if (sibling->color_ == red) {
-        sibling->color_ = black;
-        node_curr->parent_->color_ = red;
-        rotate_left(node_curr->parent_);
-        sibling = node_curr->parent_->right_;
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::delete_fix(
+    node* node_curr, node* parent) {
+  // node_curr может быть nullptr (черный лист), поэтому родитель передается
+  // отдельно
+  while (node_curr != root_ && is_black(node_curr)) {
+    if (node_curr == parent->left_) {
+      node* sibling = parent->right_;
+      if (sibling->color() == red) {
+        sibling->set_color(black);
+        parent->set_color(red);
+        rotate_left(parent);
+        sibling = parent->right_;
       }
-      if (sibling->left_->color_ == black && sibling->right_->color_ == black) {
-        sibling->color_ = red;
-        node_curr = node_curr->parent_;
+      if (is_black(sibling->left_) && is_black(sibling->right_)) {
+        sibling->set_color(red);
+        node_curr = parent;
+        parent = node_curr->parent();
       } else {
-        if (sibling->right_->color_ == black) {
-          sibling->left_->color_ = black;
-          sibling->color_ = red;
+        if (is_black(sibling->right_)) {
+          sibling->left_->set_color(black);
+          sibling->set_color(red);
           rotate_right(sibling);
-          sibling = node_curr->parent_->right_;
+          sibling = parent->right_;
         }
-        sibling->color_ = node_curr->parent_->color_;
-        node_curr->parent_->color_ = black;
-        sibling->right_->color_ = black;
-        rotate_left(node_curr->parent_);
+        sibling->set_color(parent->color());
+        parent->set_color(black);
+        sibling->right_->set_color(black);
+        rotate_left(parent);
         node_curr = root_;
       }
     } else {
-      node* sibling = node_curr->parent_->left_;
-      if (sibling->color_ == red) {
-        sibling->color_ = black;
-        node_curr->parent_->color_ = red;
-        rotate_right(node_curr->parent_);
-        sibling = node_curr->parent_->left_;
+      node* sibling = parent->left_;
+      if (sibling->color() == red) {
+        sibling->set_color(black);
+        parent->set_color(red);
+        rotate_right(parent);
+        sibling = parent->left_;
       }
-      if (sibling->left_->color_ == black && sibling->right_->color_ == black) {
-        sibling->color_ = red;
-        node_curr = node_curr->parent_;
+      if (is_black(sibling->left_) && is_black(sibling->right_)) {
+        sibling->set_color(red);
+        node_curr = parent;
+        parent = node_curr->parent();
       } else {
-        if (sibling->left_->color_ == black) {
-          sibling->right_->color_ = black;
-          sibling->color_ = red;
+        if (is_black(sibling->left_)) {
+          sibling->right_->set_color(black);
+          sibling->set_color(red);
           rotate_left(sibling);
-          sibling = node_curr->parent_->left_;
+          sibling = parent->left_;
         }
-        sibling->color_ = node_curr->parent_->color_;
-        node_curr->parent_->color_ = black;
-        sibling->left_->color_ = black;
-        rotate_right(node_curr->parent_);
+        sibling->set_color(parent->color());
+        parent->set_color(black);
+        sibling->left_->set_color(black);
+        rotate_right(parent);
         node_curr = root_;
       }
     }
   }
-  node_curr->color_ = black;
+  if (node_curr) node_curr->set_color(black);
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::reset_node(
+    node* node_curr) noexcept {
+  node_curr->left_ = nullptr;
+  node_curr->right_ = nullptr;
+  node_curr->set_parent(nullptr);
+  node_curr->set_color(red);
+  if constexpr (options::order_statistics) {
+    node_curr->subtree_size_ = 1;
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::update_size(
+    node* node_curr) noexcept {
+  if constexpr (options::order_statistics) {
+    node_curr->subtree_size_ = subtree_size(node_curr->left_) +
+                               subtree_size(node_curr->right_) + 1;
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+void s21::rb_tree<data_type, compare, allocator, options>::update_sizes_upward(
+    node* node_curr) noexcept {
+  if constexpr (options::order_statistics) {
+    for (; node_curr != nullptr; node_curr = node_curr->parent()) {
+      update_size(node_curr);
+    }
+  }
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::rb_tree<data_type, compare, allocator, options>::node*
+s21::rb_tree<data_type, compare, allocator, options>::nth_node(
+    size_t index) const {
+  static_assert(options::order_statistics,
+                "nth requires tree_options<true>");
+  node* current = root_;
+  while (current != nullptr) {
+    size_t left_size = subtree_size(current->left_);
+    if (index < left_size) {
+      current = current->left_;
+    } else if (index == left_size) {
+      return current;
+    } else {
+      index -= left_size + 1;
+      current = current->right_;
+    }
+  }
+  return nullptr;
+}
+
+// Число элементов строго меньше key: один спуск, на каждом повороте
+// вправо добавляется левое поддерево и сам узел.
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+template <typename key_type>
+size_t s21::rb_tree<data_type, compare, allocator, options>::rank_key(
+    const key_type& key) const {
+  static_assert(options::order_statistics,
+                "rank requires tree_options<true>");
+  size_t rank = 0;
+  node* current = root_;
+  while (current != nullptr) {
+    if (compare_(current->data_, key)) {
+      rank += subtree_size(current->left_) + 1;
+      current = current->right_;
+    } else {
+      current = current->left_;
+    }
+  }
+  return rank;
+}
+
+// Число элементов в полуинтервале [first, last)
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+size_t s21::rb_tree<data_type, compare, allocator, options>::count_range(
+    const data_type& first, const data_type& last) const {
+  if (!compare_(first, last)) return 0;
+  return rank_key(last) - rank_key(first);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,144 @@
+#ifndef S21_THREAD_POOL
+#define S21_THREAD_POOL
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace s21 {
+
+// Режим массовых операций деревьев
+enum class execution { sequential, parallel };
+
+// Небольшой пул потоков для массовых операций деревьев. parallel_for
+// раздает индексы рабочим потокам и сам участвует в работе. Вложенный
+// вызов из задачи (например, копия крупного элемента-контейнера) ждал бы
+// занятых рабочих, поэтому внутри задачи цикл идет последовательно.
+class thread_pool {
+ public:
+  explicit thread_pool(size_t workers);
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+  ~thread_pool();
+
+  // общий пул по числу ядер, создается при первом обращении
+  static thread_pool& shared();
+
+  // число потоков, считая вызывающий
+  size_t concurrency() const noexcept { return workers_.size() + 1; }
+  // поток - рабочий пула или выполняет parallel_for
+  static bool inside_task() noexcept { return task_depth() > 0; }
+
+  // func(i) для всех i из [0, count); первое исключение пробрасывается
+  // после завершения всех задач
+  template <typename function>
+  void parallel_for(size_t count, function&& func);
+
+ private:
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  bool stopping_ = false;
+
+  static size_t& task_depth() noexcept {
+    thread_local size_t depth = 0;
+    return depth;
+  }
+  void run();
+};
+}  // namespace s21
+
+inline s21::thread_pool::thread_pool(size_t workers) {
+  workers_.reserve(workers);
+  for (size_t i = 0; i < workers; ++i) {
+    workers_.emplace_back([this] { run(); });
+  }
+}
+
+inline s21::thread_pool::~thread_pool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  ready_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+inline s21::thread_pool& s21::thread_pool::shared() {
+  static thread_pool pool(std::thread::hardware_concurrency() > 1
+                              ? std::thread::hardware_concurrency() - 1
+                              : 0);
+  return pool;
+}
+
+inline void s21::thread_pool::run() {
+  ++task_depth();
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+template <typename function>
+void s21::thread_pool::parallel_for(size_t count, function&& func) {
+  if (inside_task()) {
+    for (size_t index = 0; index < count; ++index) func(index);
+    return;
+  }
+  std::atomic<size_t> next(0);
+  auto work = [&next, &func, count] {
+    for (size_t index = next++; index < count; index = next++) {
+      func(index);
+    }
+  };
+  size_t helpers = count > 1 ? std::min(workers_.size(), count - 1) : 0;
+  std::vector<std::future<void>> done;
+  done.reserve(helpers);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < helpers; ++i) {
+      auto task = std::make_shared<std::packaged_task<void()>>(work);
+      done.push_back(task->get_future());
+      tasks_.emplace_back([task] { (*task)(); });
+    }
+  }
+  ready_.notify_all();
+
+  std::exception_ptr error;
+  ++task_depth();
+  try {
+    work();
+  } catch (...) {
+    error = std::current_exception();
+    next = count;
+  }
+  --task_depth();
+  for (std::future<void>& result : done) {
+    try {
+      result.get();
+    } catch (...) {
+      if (!error) error = std::current_exception();
+    }
+  }
+  if (error) std::rethrow_exception(error);
+}
+
+#endif
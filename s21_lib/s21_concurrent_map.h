@@ -0,0 +1,347 @@
+#ifndef S21_CONCURRENT_MAP
+#define S21_CONCURRENT_MAP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "s21_map.h"
+
+namespace s21 {
+template <typename alloc, typename = void>
+struct has_isolated : std::false_type {};
+template <typename alloc>
+struct has_isolated<alloc, std::void_t<decltype(alloc::isolated())>>
+    : std::true_type {};
+
+// Ассоциативный массив для нескольких потоков: ключи по хешу разложены
+// между независимыми красно-черными деревьями (шардами), у каждого свой
+// замок читателей-писателей. Операции над разными шардами не мешают друг
+// другу, чтения одного шарда идут параллельно.
+template <typename Key, typename T, typename hash = std::hash<Key>,
+          typename compare = pair_compare<Key, T>,
+          typename allocator = pool_allocator<std::pair<Key, T>>>
+class concurrent_map {
+ public:
+  using shard_map = map<Key, T, compare, allocator, tree_options<>>;
+  class ordered_view;
+
+  explicit concurrent_map(size_t shards = default_shard_count());
+  concurrent_map(std::initializer_list<std::pair<Key, T>> const& items,
+                 size_t shards = default_shard_count());
+  concurrent_map(const concurrent_map& other) = delete;
+  concurrent_map& operator=(const concurrent_map& other) = delete;
+  ~concurrent_map() = default;
+
+  size_t shard_count() const noexcept { return shard_count_; }
+  size_t shard_of(const Key& key) const { return hash_(key) % shard_count_; }
+
+  // значение копируется: ссылка пережила бы замок шарда
+  std::optional<T> find(const Key& key) const;
+  bool contains(const Key& key) const;
+  bool insert(const std::pair<Key, T>& value);
+  bool insert(const Key& key, const T& obj) { return insert({key, obj}); }
+  bool insert_or_assign(const Key& key, const T& obj);
+  // func(value) под исключительным замком шарда, если ключ есть
+  template <typename function>
+  bool update(const Key& key, function&& func);
+  size_t erase(const Key& key);
+
+  // сумма по шардам, под конкурентной записью может устареть сразу
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+  void clear();
+
+  // Упорядоченный обход слиянием шардов. Пока view жив, все шарды
+  // заблокированы на чтение, и поток-владелец view не должен вызывать
+  // методы map вообще: повторный захват shared_mutex тем же потоком -
+  // неопределенное поведение. Читать в это время - через сам view.
+  ordered_view ordered() const { return ordered_view(*this); }
+
+ private:
+  // шарды в разных кэш-линиях, чтобы замки не делили линию; у каждого
+  // шарда свой пул узлов, иначе записи в разные шарды сходились бы на
+  // замке общего пула потока
+  struct alignas(64) shard {
+    shard() : data_(shard_allocator()) {}
+    mutable std::shared_mutex mutex_;
+    shard_map data_;
+  };
+
+  size_t shard_count_;
+  hash hash_;
+  std::unique_ptr<shard[]> shards_;
+
+  // с запасом к числу ядер, чтобы потоки реже сходились на одном шарде
+  static size_t default_shard_count() {
+    return std::max(std::thread::hardware_concurrency(), 1u) * 4;
+  }
+  shard& shard_for(const Key& key) const { return shards_[shard_of(key)]; }
+  static allocator shard_allocator() {
+    if constexpr (has_isolated<allocator>::value) {
+      return allocator::isolated();
+    } else {
+      return allocator();
+    }
+  }
+};
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+class concurrent_map<Key, T, hash, compare, allocator>::ordered_view {
+  friend class concurrent_map;
+
+ public:
+  class const_iterator;
+
+  const_iterator begin() const;
+  const_iterator end() const { return const_iterator(); }
+  size_t size() const;
+  // замки уже взяты view, указатель действителен, пока view жив
+  const T* find(const Key& key) const;
+  bool contains(const Key& key) const { return find(key) != nullptr; }
+
+ private:
+  explicit ordered_view(const concurrent_map& owner);
+
+  const concurrent_map* owner_;
+  std::vector<std::shared_lock<std::shared_mutex>> locks_;
+};
+
+// Куча курсоров по шардам: вершина - наименьший из текущих элементов
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+class concurrent_map<Key, T, hash, compare,
+                     allocator>::ordered_view::const_iterator {
+  friend class ordered_view;
+
+ public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = std::pair<Key, T>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const value_type*;
+  using reference = const value_type&;
+
+  const_iterator() = default;
+
+  reference operator*() const { return *operator->(); }
+  pointer operator->() const { return heap_.front().first.operator->(); }
+  const_iterator& operator++();
+  const_iterator operator++(int);
+  bool operator==(const const_iterator& other) const;
+  bool operator!=(const const_iterator& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  using shard_iterator = typename shard_map::const_iterator;
+  using cursor = std::pair<shard_iterator, shard_iterator>;
+
+  std::vector<cursor> heap_;
+  compare compare_;
+
+  bool later(const cursor& lhs, const cursor& rhs) const {
+    return compare_(*rhs.first.operator->(), *lhs.first.operator->());
+  }
+};
+}  // namespace s21
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+s21::concurrent_map<Key, T, hash, compare, allocator>::concurrent_map(
+    size_t shards)
+    : shard_count_(std::max<size_t>(shards, 1)),
+      shards_(std::make_unique<shard[]>(shard_count_)) {}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+s21::concurrent_map<Key, T, hash, compare, allocator>::concurrent_map(
+    std::initializer_list<std::pair<Key, T>> const& items, size_t shards)
+    : concurrent_map(shards) {
+  for (const std::pair<Key, T>& item : items) {
+    insert(item);
+  }
+}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+std::optional<T> s21::concurrent_map<Key, T, hash, compare, allocator>::find(
+    const Key& key) const {
+  const shard& target = shard_for(key);
+  std::shared_lock<std::shared_mutex> lock(target.mutex_);
+  auto it = target.data_.find(key);
+  if (it == target.data_.cend()) return std::nullopt;
+  return it->second;
+}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+bool s21::concurrent_map<Key, T, hash, compare, allocator>::contains(
+    const Key& key) const {
+  const shard& target = shard_for(key);
+  std::shared_lock<std::shared_mutex> lock(target.mutex_);
+  return target.data_.contains(key);
+}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+bool s21::concurrent_map<Key, T, hash, compare, allocator>::insert(
+    const std::pair<Key, T>& value) {
+  shard& target = shard_for(value.first);
+  std::unique_lock<std::shared_mutex> lock(target.mutex_);
+  return target.data_.insert(value).second;
+}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+bool s21::concurrent_map<Key, T, hash, compare, allocator>::insert_or_assign(
+    const Key& key, const T& obj) {
+  shard& target = shard_for(key);
+  std::unique_lock<std::shared_mutex> lock(target.mutex_);
+  return target.data_.insert_or_assign({key, obj}).second;
+}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+template <typename function>
+bool s21::concurrent_map<Key, T, hash, compare, allocator>::update(
+    const Key& key, function&& func) {
+  shard& target = shard_for(key);
+  std::unique_lock<std::shared_mutex> lock(target.mutex_);
+  auto it = target.data_.find(key);
+  if (it == target.data_.end()) return false;
+  func(it->second);
+  return true;
+}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+size_t s21::concurrent_map<Key, T, hash, compare, allocator>::erase(
+    const Key& key) {
+  shard& target = shard_for(key);
+  std::unique_lock<std::shared_mutex> lock(target.mutex_);
+  return target.data_.erase(key);
+}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+size_t s21::concurrent_map<Key, T, hash, compare, allocator>::size() const {
+  size_t total = 0;
+  for (size_t i = 0; i < shard_count_; ++i) {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].mutex_);
+    total += shards_[i].data_.size();
+  }
+  return total;
+}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+void s21::concurrent_map<Key, T, hash, compare, allocator>::clear() {
+  for (size_t i = 0; i < shard_count_; ++i) {
+    std::unique_lock<std::shared_mutex> lock(shards_[i].mutex_);
+    shards_[i].data_.clear();
+  }
+}
+
+// Замки берутся по возрастанию номера шарда; писатель держит не больше
+// одного замка, так что взаимной блокировки нет.
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+s21::concurrent_map<Key, T, hash, compare, allocator>::ordered_view::
+    ordered_view(const concurrent_map& owner)
+    : owner_(&owner) {
+  locks_.reserve(owner.shard_count_);
+  for (size_t i = 0; i < owner.shard_count_; ++i) {
+    locks_.emplace_back(owner.shards_[i].mutex_);
+  }
+}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+size_t s21::concurrent_map<Key, T, hash, compare,
+                           allocator>::ordered_view::size() const {
+  size_t total = 0;
+  for (size_t i = 0; i < owner_->shard_count_; ++i) {
+    total += owner_->shards_[i].data_.size();
+  }
+  return total;
+}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+const T* s21::concurrent_map<Key, T, hash, compare,
+                             allocator>::ordered_view::find(const Key& key)
+    const {
+  const shard_map& data = owner_->shard_for(key).data_;
+  auto it = data.find(key);
+  return it == data.cend() ? nullptr : &it->second;
+}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+typename s21::concurrent_map<Key, T, hash, compare,
+                             allocator>::ordered_view::const_iterator
+s21::concurrent_map<Key, T, hash, compare, allocator>::ordered_view::begin()
+    const {
+  const_iterator result;
+  for (size_t i = 0; i < owner_->shard_count_; ++i) {
+    const shard_map& data = owner_->shards_[i].data_;
+    if (data.cbegin() != data.cend()) {
+      result.heap_.emplace_back(data.cbegin(), data.cend());
+    }
+  }
+  std::make_heap(result.heap_.begin(), result.heap_.end(),
+                 [&result](const auto& lhs, const auto& rhs) {
+                   return result.later(lhs, rhs);
+                 });
+  return result;
+}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+typename s21::concurrent_map<Key, T, hash, compare,
+                             allocator>::ordered_view::const_iterator&
+s21::concurrent_map<Key, T, hash, compare,
+                    allocator>::ordered_view::const_iterator::operator++() {
+  auto later_first = [this](const cursor& lhs, const cursor& rhs) {
+    return later(lhs, rhs);
+  };
+  std::pop_heap(heap_.begin(), heap_.end(), later_first);
+  cursor& top = heap_.back();
+  if (++top.first == top.second) {
+    heap_.pop_back();
+  } else {
+    std::push_heap(heap_.begin(), heap_.end(), later_first);
+  }
+  return *this;
+}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+typename s21::concurrent_map<Key, T, hash, compare,
+                             allocator>::ordered_view::const_iterator
+s21::concurrent_map<Key, T, hash, compare,
+                    allocator>::ordered_view::const_iterator::operator++(int) {
+  const_iterator previous(*this);
+  ++*this;
+  return previous;
+}
+
+template <typename Key, typename T, typename hash, typename compare,
+          typename allocator>
+bool s21::concurrent_map<Key, T, hash, compare, allocator>::ordered_view::
+    const_iterator::operator==(const const_iterator& other) const {
+  if (heap_.empty() || other.heap_.empty()) {
+    return heap_.empty() == other.heap_.empty();
+  }
+  return heap_.front().first == other.heap_.front().first;
+}
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef S21_FLAT_MAP
+#define S21_FLAT_MAP
+
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "flat_tree/flat_tree.h"
+#include "s21_map.h"
+
+namespace s21 {
+// Интерфейс map над отсортированным массивом пар: итераторы
+// недействительны после любого изменения
+template <typename Key, typename T, typename compare = pair_compare<Key, T>>
+class flat_map : public flat_tree<std::pair<Key, T>, compare> {
+  using base = flat_tree<std::pair<Key, T>, compare>;
+
+ public:
+  using iterator = typename base::iterator;
+  using const_iterator = typename base::const_iterator;
+
+  flat_map() : base() {}
+  flat_map(std::initializer_list<std::pair<Key, T>> const& items)
+      : base(items) {}
+  template <typename input_iterator,
+            typename = typename std::iterator_traits<
+                input_iterator>::iterator_category>
+  flat_map(input_iterator first, input_iterator last) : base(first, last) {}
+  flat_map(const flat_map& other) : base(other) {}
+  flat_map(flat_map&& other) noexcept : base(std::move(other)) {}
+  ~flat_map() = default;
+  flat_map& operator=(const flat_map& other) {
+    base::operator=(other);
+    return *this;
+  }
+  flat_map& operator=(flat_map&& other) noexcept {
+    base::operator=(std::move(other));
+    return *this;
+  }
+
+  T& at(const Key& key);
+  const T& at(const Key& key) const;
+  T& operator[](const Key& key) { return try_emplace(key).first->second; }
+
+  iterator find(const Key& key) {
+    return this->find_by(search_key<Key, T, compare>(key));
+  }
+  const_iterator find(const Key& key) const {
+    return this->find_by(search_key<Key, T, compare>(key));
+  }
+  iterator lower_bound(const Key& key) {
+    return this->lower_bound_by(search_key<Key, T, compare>(key));
+  }
+  const_iterator lower_bound(const Key& key) const {
+    return this->lower_bound_by(search_key<Key, T, compare>(key));
+  }
+  iterator upper_bound(const Key& key) {
+    return this->upper_bound_by(search_key<Key, T, compare>(key));
+  }
+  const_iterator upper_bound(const Key& key) const {
+    return this->upper_bound_by(search_key<Key, T, compare>(key));
+  }
+  std::pair<iterator, iterator> equal_range(const Key& key) {
+    return {lower_bound(key), upper_bound(key)};
+  }
+  std::pair<const_iterator, const_iterator> equal_range(
+      const Key& key) const {
+    return {lower_bound(key), upper_bound(key)};
+  }
+
+  std::pair<iterator, bool> insert(const std::pair<Key, T>& value) {
+    return this->insert_data(value);
+  }
+  std::pair<iterator, bool> insert(std::pair<Key, T>&& value) {
+    return this->insert_unique(std::move(value));
+  }
+  iterator insert(const_iterator hint, const std::pair<Key, T>& value) {
+    return this->insert_hint(hint, value);
+  }
+  iterator insert(const_iterator hint, std::pair<Key, T>&& value) {
+    return this->insert_hint(hint, std::move(value));
+  }
+  std::pair<iterator, bool> insert(const Key& key, const T& obj) {
+    return try_emplace(key, obj);
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    return this->emplace_data(std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  iterator emplace_hint(const_iterator hint, Args&&... args) {
+    return this->emplace_hint_data(hint, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+    return try_emplace_key(key, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+    return try_emplace_key(std::move(key), std::forward<Args>(args)...);
+  }
+  std::pair<iterator, bool> insert_or_assign(const std::pair<Key, T>& value);
+  void erase(iterator pos) { base::erase(pos); }
+  iterator erase(iterator first, iterator last) {
+    return base::erase(first, last);
+  }
+  size_t erase(const Key& key) {
+    return this->erase_by(search_key<Key, T, compare>(key));
+  }
+  void swap(flat_map& other) noexcept { base::swap(other); }
+  void merge(flat_map& other) { base::merge(other); }
+  bool contains(const Key& key) const { return find(key) != this->cend(); }
+  size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+  // аргументы сортируются и вливаются в массив один раз; итераторы
+  // результата указывают в итоговый массив
+  template <typename... Args>
+  std::vector<std::pair<iterator, bool>> insert_many(Args&&... args) {
+    return this->insert_batch(std::forward<Args>(args)...);
+  }
+
+ private:
+  template <typename key_arg, typename... Args>
+  std::pair<iterator, bool> try_emplace_key(key_arg&& key, Args&&... args);
+};
+}  // namespace s21
+
+template <typename Key, typename T, typename compare>
+T& s21::flat_map<Key, T, compare>::at(const Key& key) {
+  iterator it = find(key);
+  if (it == this->end()) {
+    throw std::out_of_range("flat_map::at");
+  }
+  return it->second;
+}
+
+template <typename Key, typename T, typename compare>
+const T& s21::flat_map<Key, T, compare>::at(const Key& key) const {
+  const_iterator it = find(key);
+  if (it == this->cend()) {
+    throw std::out_of_range("flat_map::at");
+  }
+  return it->second;
+}
+
+// Пара строится только если ключа еще нет, вставка идет в найденную
+// нижнюю границу без повторного поиска.
+template <typename Key, typename T, typename compare>
+template <typename key_arg, typename... Args>
+std::pair<typename s21::flat_map<Key, T, compare>::iterator, bool>
+s21::flat_map<Key, T, compare>::try_emplace_key(key_arg&& key,
+                                                Args&&... args) {
+  iterator position = lower_bound(key);
+  if (position != this->end() &&
+      !this->compare_(search_key<Key, T, compare>(key), *position)) {
+    return {position, false};
+  }
+  return {this->emplace_hint_data(
+              position, std::piecewise_construct,
+              std::forward_as_tuple(std::forward<key_arg>(key)),
+              std::forward_as_tuple(std::forward<Args>(args)...)),
+          true};
+}
+
+template <typename Key, typename T, typename compare>
+std::pair<typename s21::flat_map<Key, T, compare>::iterator, bool>
+s21::flat_map<Key, T, compare>::insert_or_assign(
+    const std::pair<Key, T>& value) {
+  iterator it = find(value.first);
+  if (it != this->end()) {
+    it->second = value.second;
+    return {it, false};
+  }
+  return this->insert(value);
+}
+
+#endif
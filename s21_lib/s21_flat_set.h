@@ -0,0 +1,73 @@
+#ifndef S21_FLAT_SET
+#define S21_FLAT_SET
+
+#include <vector>
+
+#include "flat_tree/flat_tree.h"
+
+namespace s21 {
+// Интерфейс set над отсортированным массивом: итераторы недействительны
+// после любого изменения
+template <typename data_type, typename compare = std::less<data_type>>
+class flat_set : public flat_tree<data_type, compare> {
+  using base = flat_tree<data_type, compare>;
+
+ public:
+  using iterator = typename base::iterator;
+  using const_iterator = typename base::const_iterator;
+
+  flat_set() : base() {}
+  flat_set(std::initializer_list<data_type> const &items) : base(items) {}
+  template <typename input_iterator,
+            typename = typename std::iterator_traits<
+                input_iterator>::iterator_category>
+  flat_set(input_iterator first, input_iterator last) : base(first, last) {}
+  flat_set(const flat_set &other) : base(other) {}
+  flat_set(flat_set &&other) noexcept : base(std::move(other)) {}
+  ~flat_set() = default;
+  flat_set &operator=(const flat_set &other) {
+    base::operator=(other);
+    return *this;
+  }
+  flat_set &operator=(flat_set &&other) noexcept {
+    base::operator=(std::move(other));
+    return *this;
+  }
+
+  std::pair<iterator, bool> insert(const data_type &value) {
+    return this->insert_data(value);
+  }
+  std::pair<iterator, bool> insert(data_type &&value) {
+    return this->insert_unique(std::move(value));
+  }
+  iterator insert(const_iterator hint, const data_type &value) {
+    return this->insert_hint(hint, value);
+  }
+  iterator insert(const_iterator hint, data_type &&value) {
+    return this->insert_hint(hint, std::move(value));
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    return this->emplace_data(std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return this->emplace_hint_data(hint, std::forward<Args>(args)...);
+  }
+  void swap(flat_set &other) noexcept { base::swap(other); }
+  void merge(flat_set &other) { base::merge(other); }
+  bool contains(const data_type &key) const {
+    return this->find(key) != this->cend();
+  }
+  size_t count(const data_type &key) const { return contains(key) ? 1 : 0; }
+
+  // аргументы сортируются и вливаются в массив один раз; итераторы
+  // результата указывают в итоговый массив
+  template <typename... Args>
+  std::vector<std::pair<iterator, bool>> insert_many(Args &&...args) {
+    return this->insert_batch(std::forward<Args>(args)...);
+  }
+};
+}  // namespace s21
+
+#endif
@@ -1,30 +1,67 @@
 #ifndef S21_MAP
 #define S21_MAP
 
+#include <tuple>
 #include <vector>
 
+#include "btree/btree.h"
+#include "eytzinger/eytzinger_tree.h"
 #include "red_black_tree/rb_tree.h"
 
 namespace s21 {
+template <typename Key, typename T, typename compare, typename allocator,
+          typename options>
+class frozen_map;
+
 template <typename Key, typename T>
 struct pair_compare {
+  using is_transparent = void;
+
   bool operator()(const std::pair<Key, T>& lhs,
                   const std::pair<Key, T>& rhs) const {
     return lhs.first < rhs.first;
   }
+  bool operator()(const Key& lhs, const std::pair<Key, T>& rhs) const {
+    return lhs < rhs.first;
+  }
+  bool operator()(const std::pair<Key, T>& lhs, const Key& rhs) const {
+    return lhs.first < rhs;
+  }
 };
 
-template <typename Key, typename T, typename compare = pair_compare<Key, T>>
-class map : public rb_tree<std::pair<Key, T>, compare> {
-  using base = rb_tree<std::pair<Key, T>, compare>;
+// Ключ поиска в дереве пар: с прозрачным компаратором поиск идет по самому
+// ключу, иначе приходится собирать пару с сконструированным по умолчанию
+// значением.
+template <typename Key, typename T, typename compare>
+decltype(auto) search_key(const Key& key) {
+  if constexpr (is_transparent<compare>::value) {
+    return (key);
+  } else {
+    return std::make_pair(key, T{});
+  }
+}
+
+template <typename Key, typename T, typename compare = pair_compare<Key, T>,
+          typename allocator = pool_allocator<std::pair<Key, T>>,
+          typename options = tree_options<>>
+class map : public tree_base<std::pair<Key, T>, compare, allocator, options> {
+  using base = tree_base<std::pair<Key, T>, compare, allocator, options>;
 
  public:
   using iterator = typename base::iterator;
   using const_iterator = typename base::const_iterator;
+  using node_type = typename base::node_handle;
+  using insert_return_type = typename base::insert_return_type;
 
   map() : base() {}
+  explicit map(const allocator& alloc) : base(alloc) {}
   map(std::initializer_list<std::pair<Key, T>> const& items);
+  template <typename input_iterator,
+            typename = typename std::iterator_traits<
+                input_iterator>::iterator_category>
+  map(input_iterator first, input_iterator last) : base(first, last) {}
   map(const map& other) : base(other) {}
+  map(const map& other, execution policy) : base(other, policy) {}
   map(map&& other) noexcept : base(std::move(other)) {}
   ~map() = default;
 
@@ -36,12 +73,55 @@ class map : public rb_tree<std::pair<Key, T>, compare> {
 
   iterator begin() { return base::begin(); }
   iterator end() { return base::end(); }
-  iterator find(const Key& key) { return base::find(std::make_pair(key, T{})); }
+  iterator find(const Key& key) {
+    return this->find_by(search_key<Key, T, compare>(key));
+  }
 
   const_iterator cbegin() const { return base::cbegin(); }
   const_iterator cend() const { return base::cend(); }
   const_iterator find(const Key& key) const {
-    return base::find(std::make_pair(key, T{}));
+    return this->find_by(search_key<Key, T, compare>(key));
+  }
+  iterator lower_bound(const Key& key) {
+    return this->lower_bound_by(search_key<Key, T, compare>(key));
+  }
+  const_iterator lower_bound(const Key& key) const {
+    return this->lower_bound_by(search_key<Key, T, compare>(key));
+  }
+  iterator upper_bound(const Key& key) {
+    return this->upper_bound_by(search_key<Key, T, compare>(key));
+  }
+  const_iterator upper_bound(const Key& key) const {
+    return this->upper_bound_by(search_key<Key, T, compare>(key));
+  }
+  // итераторы найденных пар или end() в порядке ключей; поиски идут
+  // группами вперемешку, чтобы промахи кэша перекрывались
+  template <typename key_iterator, typename output_iterator>
+  output_iterator find_many(key_iterator first, key_iterator last,
+                            output_iterator out) {
+    if constexpr (is_transparent<compare>::value) {
+      return base::find_many(first, last, out);
+    } else {
+      std::vector<std::pair<Key, T>> probes = search_keys(first, last);
+      return base::find_many(probes.begin(), probes.end(), out);
+    }
+  }
+  template <typename key_iterator, typename output_iterator>
+  output_iterator find_many(key_iterator first, key_iterator last,
+                            output_iterator out) const {
+    if constexpr (is_transparent<compare>::value) {
+      return base::find_many(first, last, out);
+    } else {
+      std::vector<std::pair<Key, T>> probes = search_keys(first, last);
+      return base::find_many(probes.begin(), probes.end(), out);
+    }
+  }
+  std::pair<iterator, iterator> equal_range(const Key& key) {
+    return {lower_bound(key), upper_bound(key)};
+  }
+  std::pair<const_iterator, const_iterator> equal_range(
+      const Key& key) const {
+    return {lower_bound(key), upper_bound(key)};
   }
 
   bool empty() const noexcept { return base::empty(); }
@@ -52,40 +132,156 @@ class map : public rb_tree<std::pair<Key, T>, compare> {
   std::pair<iterator, bool> insert(const std::pair<Key, T>& value) {
     return this->insert_data(value);
   }
-  std::pair<iterator, bool> insert(const Key& key, const T& obj);
+  std::pair<iterator, bool> insert(std::pair<Key, T>&& value) {
+    return this->insert_unique(std::move(value));
+  }
+  iterator insert(iterator hint, const std::pair<Key, T>& value) {
+    return this->insert_hint(hint, value);
+  }
+  iterator insert(iterator hint, std::pair<Key, T>&& value) {
+    return this->insert_hint(hint, std::move(value));
+  }
+  std::pair<iterator, bool> insert(const Key& key, const T& obj) {
+    return try_emplace(key, obj);
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    return this->emplace_data(std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  iterator emplace_hint(iterator hint, Args&&... args) {
+    return this->emplace_hint_data(hint, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+    return try_emplace_key(key, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+    return try_emplace_key(std::move(key), std::forward<Args>(args)...);
+  }
   std::pair<iterator, bool> insert_or_assign(const std::pair<Key, T>& value);
+  insert_return_type insert(node_type&& handle) {
+    return this->insert_handle(std::move(handle));
+  }
   void erase(iterator pos) { base::erase(pos); }
+  iterator erase(iterator first, iterator last) {
+    return base::erase(first, last);
+  }
+  size_t erase(const Key& key);
+  node_type extract(iterator pos) { return base::extract(pos); }
+  node_type extract(const Key& key) { return base::extract(find(key)); }
   void swap(map& other) noexcept { base::swap(other); }
   void merge(map& other) { base::merge(other); }
-  bool contains(const Key& key) const {
-    return this->find(key) != this->cend();
+  // элементы с ключом не меньше key переезжают в возвращаемый map
+  map split(const Key& key);
+  void join(const std::pair<Key, T>& pivot, map& right) {
+    base::join(pivot, right);
+  }
+  void join(map& right) { base::join(right); }
+  bool contains(const Key& key) const { return find(key) != this->cend(); }
+  size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+  size_t rank(const Key& key) const {
+    return this->rank_key(search_key<Key, T, compare>(key));
+  }
+  size_t count_range(const Key& first, const Key& last) const {
+    size_t lower = rank(first);
+    size_t upper = rank(last);
+    return upper > lower ? upper - lower : 0;
   }
   template <typename... Args>
-  std::vector<std::pair<typename map<Key, T, compare>::iterator, bool>>
-  insert_many(Args&&... args);
+  std::vector<std::pair<iterator, bool>> insert_many(Args&&... args);
+
+  // неизменяемая копия в раскладке Эйтцингера для частых чтений
+  frozen_map<Key, T, compare, allocator, options> freeze() const {
+    return frozen_map<Key, T, compare, allocator, options>(*this);
+  }
+
+ private:
+  template <typename key_iterator>
+  static std::vector<std::pair<Key, T>> search_keys(key_iterator first,
+                                                    key_iterator last) {
+    std::vector<std::pair<Key, T>> probes;
+    for (; first != last; ++first) {
+      probes.push_back(search_key<Key, T, compare>(*first));
+    }
+    return probes;
+  }
+  template <typename key_arg, typename... Args>
+  std::pair<iterator, bool> try_emplace_key(key_arg&& key, Args&&... args);
+};
+
+// Снимок map только для чтения в раскладке Эйтцингера; значения меняются
+// только через thaw()
+template <typename Key, typename T, typename compare, typename allocator,
+          typename options>
+class frozen_map : public eytzinger_tree<std::pair<Key, T>, compare> {
+  using base = eytzinger_tree<std::pair<Key, T>, compare>;
+
+ public:
+  using iterator = typename base::iterator;
+  using const_iterator = typename base::const_iterator;
+
+  frozen_map() : base() {}
+  explicit frozen_map(const map<Key, T, compare, allocator, options>& source)
+      : base(source.cbegin(), source.cend(), source.size()) {}
+
+  const T& at(const Key& key) const;
+  const_iterator find(const Key& key) const {
+    return this->find_by(search_key<Key, T, compare>(key));
+  }
+  const_iterator lower_bound(const Key& key) const {
+    return const_iterator(this,
+                          this->lower_index(search_key<Key, T, compare>(key)));
+  }
+  const_iterator upper_bound(const Key& key) const {
+    return const_iterator(this,
+                          this->upper_index(search_key<Key, T, compare>(key)));
+  }
+  std::pair<const_iterator, const_iterator> equal_range(
+      const Key& key) const {
+    return {lower_bound(key), upper_bound(key)};
+  }
+  bool contains(const Key& key) const { return find(key) != this->cend(); }
+  size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+  map<Key, T, compare, allocator, options> thaw() const {
+    return map<Key, T, compare, allocator, options>(this->begin(),
+                                                     this->end());
+  }
 };
 }  // namespace s21
 
-template <typename Key, typename T, typename compare>
-s21::map<Key, T, compare>::map(
-    std::initializer_list<std::pair<Key, T>> const& items)
-    : base() {
-  for (const auto& item : items) {
-    this->insert(item);
+template <typename Key, typename T, typename compare, typename allocator,
+          typename options>
+const T& s21::frozen_map<Key, T, compare, allocator, options>::at(
+    const Key& key) const {
+  const_iterator it = find(key);
+  if (it == this->cend()) {
+    throw std::out_of_range("frozen_map::at");
   }
+  return it->second;
 }
 
-template <typename Key, typename T, typename compare>
-s21::map<Key, T, compare>& s21::map<Key, T, compare>::operator=(
-    map&& other) noexcept {
+template <typename Key, typename T, typename compare, typename allocator,
+          typename options>
+s21::map<Key, T, compare, allocator, options>::map(
+    std::initializer_list<std::pair<Key, T>> const& items)
+    : base(items.begin(), items.end()) {}
+
+template <typename Key, typename T, typename compare, typename allocator,
+          typename options>
+s21::map<Key, T, compare, allocator, options>&
+s21::map<Key, T, compare, allocator, options>::operator=(map&& other) noexcept {
   if (this != &other) {
     base::operator=(std::move(other));
   }
   return *this;
 }
 
-template <typename Key, typename T, typename compare>
-T& s21::map<Key, T, compare>::at(const Key& key) {
+template <typename Key, typename T, typename compare, typename allocator,
+          typename options>
+T& s21::map<Key, T, compare, allocator, options>::at(const Key& key) {
   auto it = this->find(key);
   if (it == this->end()) {
     throw std::out_of_range("map::at");
@@ -93,8 +289,10 @@ T& s21::map<Key, T, compare>::at(const Key& key) {
   return it->second;
 }
 
-template <typename Key, typename T, typename compare>
-const T& s21::map<Key, T, compare>::at(const Key& key) const {
+template <typename Key, typename T, typename compare, typename allocator,
+          typename options>
+const T&
+s21::map<Key, T, compare, allocator, options>::at(const Key& key) const {
   auto it = this->find(key);
   if (it == this->cend()) {
     throw std::out_of_range("map::at");
@@ -102,22 +300,65 @@ const T& s21::map<Key, T, compare>::at(const Key& key) const {
   return it->second;
 }
 
-template <typename Key, typename T, typename compare>
-T& s21::map<Key, T, compare>::operator[](const Key& key) {
-  auto result = this->insert(std::make_pair(key, T{}));
-  return result.first->second;
+template <typename Key, typename T, typename compare, typename allocator,
+          typename options>
+T& s21::map<Key, T, compare, allocator, options>::operator[](const Key& key) {
+  return try_emplace(key).first->second;
 }
 
-template <typename Key, typename T, typename compare>
-std::pair<typename s21::map<Key, T, compare>::iterator, bool>
-s21::map<Key, T, compare>::insert(const Key& key, const T& obj) {
-  std::pair<Key, T> value(key, obj);
-  return this->insert(value);
+template <typename Key, typename T, typename compare, typename allocator,
+          typename options>
+size_t s21::map<Key, T, compare, allocator, options>::erase(const Key& key) {
+  iterator position = find(key);
+  if (position == end()) return 0;
+  base::erase(position);
+  return 1;
 }
 
-template <typename Key, typename T, typename compare>
-std::pair<typename s21::map<Key, T, compare>::iterator, bool>
-s21::map<Key, T, compare>::insert_or_assign(const std::pair<Key, T>& value) {
+template <typename Key, typename T, typename compare, typename allocator,
+          typename options>
+s21::map<Key, T, compare, allocator, options>
+s21::map<Key, T, compare, allocator, options>::split(const Key& key) {
+  map right(this->get_allocator());
+  this->split_into(search_key<Key, T, compare>(key), right);
+  return right;
+}
+
+// Значение строится прямо в узле и только если ключа еще нет; найденная
+// нижняя граница служит подсказкой для вставки.
+template <typename Key, typename T, typename compare, typename allocator,
+          typename options>
+template <typename key_arg, typename... Args>
+std::pair<typename s21::map<Key, T, compare, allocator, options>::iterator,
+          bool>
+s21::map<Key, T, compare, allocator, options>::try_emplace_key(key_arg&& key,
+                                                               Args&&... args) {
+  if constexpr (is_transparent<compare>::value) {
+    iterator position = this->lower_bound_by(key);
+    // operator-> не строит значение по умолчанию для end()
+    if (position != end() && !this->compare_(key, *position.operator->())) {
+      return std::make_pair(position, false);
+    }
+    return std::make_pair(
+        this->emplace_hint_data(
+            position, std::piecewise_construct,
+            std::forward_as_tuple(std::forward<key_arg>(key)),
+            std::forward_as_tuple(std::forward<Args>(args)...)),
+        true);
+  } else {
+    return this->emplace_data(
+        std::piecewise_construct,
+        std::forward_as_tuple(std::forward<key_arg>(key)),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+}
+
+template <typename Key, typename T, typename compare, typename allocator,
+          typename options>
+std::pair<typename s21::map<Key, T, compare, allocator, options>::iterator,
+          bool>
+s21::map<Key, T, compare, allocator, options>::insert_or_assign(
+    const std::pair<Key, T>& value) {
   auto it = this->find(value.first);
   if (it != this->end()) {
     it->second = value.second;
@@ -127,10 +368,15 @@ s21::map<Key, T, compare>::insert_or_assign(const std::pair<Key, T>& value) {
   }
 }
 
-template <typename Key, typename T, typename compare>
+template <typename Key, typename T, typename compare, typename allocator,
+          typename options>
 template <typename... Args>
-std::vector<std::pair<typename s21::map<Key, T, compare>::iterator, bool>>
-s21::map<Key, T, compare>::insert_many(Args&&... args) {
+std::vector<std::pair<
+    typename s21::map<Key, T, compare, allocator, options>::iterator, bool>>
+s21::map<Key, T, compare, allocator, options>::insert_many(Args&&... args) {
+  // итераторы ранних вставок должны пережить следующие вставки
+  static_assert(options::stable_iterators,
+                "insert_many needs a backend with stable iterators");
   std::vector<std::pair<iterator, bool>> results;
   (results.emplace_back(this->insert(std::forward<Args>(args))), ...);
   return results;
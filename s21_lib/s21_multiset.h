@@ -1,21 +1,33 @@
 #ifndef S21_MULTISET
 #define S21_MULTISET
 
+#include "btree/btree.h"
 #include "red_black_tree/rb_tree.h"
 
 namespace s21 {
 
-template <typename data_type, typename compare = std::less<data_type>>
-class multiset : public rb_tree<data_type, compare> {
-  using base = rb_tree<data_type, compare>;
+template <typename data_type, typename compare = std::less<data_type>,
+          typename allocator = pool_allocator<data_type>,
+          typename options = tree_options<>>
+class multiset : public tree_base<data_type, compare, allocator, options> {
+  using base = tree_base<data_type, compare, allocator, options>;
 
  public:
   using iterator = typename base::iterator;
   using const_iterator = typename base::const_iterator;
+  using node_type = typename base::node_handle;
 
   multiset() : base() {}
+  explicit multiset(const allocator& alloc) : base(alloc) {}
   multiset(std::initializer_list<data_type> const& items);
+  template <typename input_iterator,
+            typename = typename std::iterator_traits<
+                input_iterator>::iterator_category>
+  multiset(input_iterator first, input_iterator last) {
+    this->assign_sorted(first, last);
+  }
   multiset(const multiset& other) : base(other) {}
+  multiset(const multiset& other, execution policy) : base(other, policy) {}
   multiset(multiset&& other) noexcept : base(std::move(other)) {}
   ~multiset() = default;  // +
 
@@ -36,121 +48,128 @@ class multiset : public rb_tree<data_type, compare> {
   size_t max_size() const noexcept { return base::max_size(); }
 
   void clear() { base::clear(); }
-  iterator insert(const data_type& value) { return insert_data(value).first; }
-  void erase(iterator pos);
+  iterator insert(const data_type& value) {
+    return this->insert_data(value).first;
+  }
+  iterator insert(data_type&& value) {
+    return this->insert_equal(std::move(value));
+  }
+  iterator insert(iterator hint, const data_type& value) {
+    return this->insert_hint(hint, value);
+  }
+  iterator insert(iterator hint, data_type&& value) {
+    return this->insert_hint(hint, std::move(value));
+  }
+  template <typename... Args>
+  iterator emplace(Args&&... args) {
+    return this->emplace_data(std::forward<Args>(args)...).first;
+  }
+  template <typename... Args>
+  iterator emplace_hint(iterator hint, Args&&... args) {
+    return this->emplace_hint_data(hint, std::forward<Args>(args)...);
+  }
+  iterator insert(node_type&& handle) {
+    return this->insert_handle(std::move(handle)).position;
+  }
+  void erase(iterator pos) { base::erase(pos); }
+  iterator erase(iterator first, iterator last) {
+    return base::erase(first, last);
+  }
+  size_t erase(const data_type& value) { return base::erase(value); }
+  node_type extract(iterator pos) { return base::extract(pos); }
+  node_type extract(const data_type& key);
   void swap(multiset& other) noexcept { base::swap(other); }
   void merge(multiset& other) { base::merge(other); }
+  // элементы не меньше key переезжают в возвращаемый multiset
+  multiset split(const data_type& key) {
+    multiset right(this->get_allocator());
+    this->split_into(key, right);
+    return right;
+  }
+  void join(const data_type& pivot, multiset& right) {
+    base::join(pivot, right);
+  }
+  void join(multiset& right) { base::join(right); }
   bool contains(const data_type& key) const {
     return this->find(key) != this->cend();
   }
 
-  iterator upper_bound(const data_type& key);
-  iterator lower_bound(const data_type& key);
-
-  std::pair<iterator, iterator> equal_range(const data_type& value);
-
  private:
-  std::pair<typename rb_tree<data_type, compare>::iterator, bool> insert_data(
-      const data_type& data) override;
+  bool allows_duplicates() const noexcept override { return true; }
 };
-}  // namespace s21
 
-template <typename data_type, typename compare>
-s21::multiset<data_type, compare>::multiset(
-    std::initializer_list<data_type> const& items) {
-  for (auto& item : items) {
-    this->insert_data(item);
-  }
+// Кратности результата как у std::set_union и родственных алгоритмов
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+multiset<data_type, compare, allocator, options> set_union(
+    const multiset<data_type, compare, allocator, options>& lhs,
+    const multiset<data_type, compare, allocator, options>& rhs,
+    execution policy = execution::sequential) {
+  multiset<data_type, compare, allocator, options> result;
+  result.assign_union(lhs, rhs, policy);
+  return result;
 }
 
-template <typename data_type, typename compare>
-s21::multiset<data_type, compare>& s21::multiset<data_type, compare>::operator=(
-    multiset&& other) noexcept {
-  if (this != &other) {
-    base::operator=(std::move(other));
-  }
-  return *this;
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+multiset<data_type, compare, allocator, options> set_intersection(
+    const multiset<data_type, compare, allocator, options>& lhs,
+    const multiset<data_type, compare, allocator, options>& rhs,
+    execution policy = execution::sequential) {
+  multiset<data_type, compare, allocator, options> result;
+  result.assign_intersection(lhs, rhs, policy);
+  return result;
 }
 
-template <typename data_type, typename compare>
-void s21::multiset<data_type, compare>::erase(iterator pos) {
-  const data_type& key = *pos;
-  auto range = equal_range(key);
-  for (auto it = range.first; it != range.second;) {
-    auto current = it++;
-    if (current == pos) {
-      base::erase(current);
-    }
-  }
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+multiset<data_type, compare, allocator, options> set_difference(
+    const multiset<data_type, compare, allocator, options>& lhs,
+    const multiset<data_type, compare, allocator, options>& rhs,
+    execution policy = execution::sequential) {
+  multiset<data_type, compare, allocator, options> result;
+  result.assign_difference(lhs, rhs, policy);
+  return result;
 }
 
-template <typename data_type, typename compare>
-typename s21::multiset<data_type, compare>::iterator
-s21::multiset<data_type, compare>::upper_bound(const data_type& key) {
-  typename base::node* current_node = base::root_;
-  iterator upper_bound = base::end();
-  while (current_node != nullptr) {
-    if (base::compare_(key, current_node->data_)) {
-      upper_bound = iterator(current_node, this);
-      current_node = current_node->left_;
-    } else {
-      current_node = current_node->right_;
-    }
-  }
-  return upper_bound;
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+multiset<data_type, compare, allocator, options> set_symmetric_difference(
+    const multiset<data_type, compare, allocator, options>& lhs,
+    const multiset<data_type, compare, allocator, options>& rhs,
+    execution policy = execution::sequential) {
+  multiset<data_type, compare, allocator, options> result;
+  result.assign_symmetric_difference(lhs, rhs, policy);
+  return result;
 }
+}  // namespace s21
 
-template <typename data_type, typename compare>
-typename s21::multiset<data_type, compare>::iterator
-s21::multiset<data_type, compare>::lower_bound(const data_type& key) {
-  typename base::node* current_node = base::root_;
-  iterator lower_bound = base::end();
-  while (current_node != nullptr) {
-    if (!base::compare_(current_node->data_, key)) {
-      lower_bound = iterator(current_node, this);
-      current_node = current_node->left_;
-    } else {
-      current_node = current_node->right_;
-    }
-  }
-  return lower_bound;
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+s21::multiset<data_type, compare, allocator, options>::multiset(
+    std::initializer_list<data_type> const& items) {
+  this->assign_sorted(items.begin(), items.end());
 }
 
-template <typename data_type, typename compare>
-std::pair<typename s21::multiset<data_type, compare>::iterator,
-          typename s21::multiset<data_type, compare>::iterator>
-s21::multiset<data_type, compare>::equal_range(const data_type& value) {
-  iterator first = lower_bound(value);
-  iterator last = upper_bound(value);
-  return std::make_pair(first, last);
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+s21::multiset<data_type, compare, allocator, options>&
+s21::multiset<data_type, compare, allocator, options>::operator=(
+    multiset&& other) noexcept {
+  if (this != &other) {
+    base::operator=(std::move(other));
+  }
+  return *this;
 }
 
-template <typename data_type, typename compare>
-std::pair<typename s21::multiset<data_type, compare>::iterator, bool>
-s21::multiset<data_type, compare>::insert_data(const data_type& data) {
-  typename base::node* current_node = base::root_;
-  typename base::node* parent_node = nullptr;
-  while (current_node != nullptr) {
-    parent_node = current_node;
-    if (this->compare_(data, current_node->data_)) {
-      current_node = current_node->left_;
-    } else {
-      current_node = current_node->right_;
-    }
-  }
-  typename base::node* new_node = new typename base::node(data, nullptr);
-  new_node->parent_ = parent_node;
-
-  if (parent_node == nullptr) {
-    base::root_ = new_node;
-  } else if (!this->compare_(data, parent_node->data_)) {
-    parent_node->right_ = new_node;
-  } else {
-    parent_node->left_ = new_node;
-  }
-  this->fix_violation(new_node);
-  ++base::size_;
-  return std::make_pair(typename base::iterator(new_node, this), true);
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+typename s21::multiset<data_type, compare, allocator, options>::node_type
+s21::multiset<data_type, compare, allocator, options>::extract(
+    const data_type& key) {
+  iterator first = this->lower_bound(key);
+  if (first == end() || base::compare_(key, *first)) return node_type();
+  return base::extract(first);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef S21_PERSISTENT_MAP
+#define S21_PERSISTENT_MAP
+
+#include <stdexcept>
+#include <utility>
+
+#include "red_black_tree/persistent_rb_tree.h"
+#include "s21_map.h"
+
+namespace s21 {
+// Интерфейс map над неизменяемым деревом: изменения возвращают новую
+// версию, копия - снимок за O(1). Для публикации версий читателям из
+// других потоков - s21::versioned<persistent_map<...>>.
+template <typename Key, typename T, typename compare = pair_compare<Key, T>>
+class persistent_map : public persistent_rb_tree<std::pair<Key, T>, compare> {
+  using base = persistent_rb_tree<std::pair<Key, T>, compare>;
+
+ public:
+  using iterator = typename base::iterator;
+  using const_iterator = typename base::const_iterator;
+
+  persistent_map() : base() {}
+  persistent_map(std::initializer_list<std::pair<Key, T>> const& items)
+      : base(items) {}
+
+  const T& at(const Key& key) const;
+  const_iterator find(const Key& key) const {
+    return this->find_by(search_key<Key, T, compare>(key));
+  }
+  const_iterator lower_bound(const Key& key) const {
+    return this->lower_bound_by(search_key<Key, T, compare>(key));
+  }
+  bool contains(const Key& key) const { return find(key) != this->cend(); }
+  size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+  persistent_map insert(const std::pair<Key, T>& value) const {
+    return persistent_map(base::insert(value));
+  }
+  persistent_map insert(const Key& key, const T& obj) const {
+    return insert(std::make_pair(key, obj));
+  }
+  persistent_map insert_or_assign(const Key& key, const T& obj) const {
+    return persistent_map(base::insert_or_assign(std::make_pair(key, obj)));
+  }
+  persistent_map erase(const Key& key) const {
+    return persistent_map(this->erase_by(search_key<Key, T, compare>(key)));
+  }
+
+ private:
+  explicit persistent_map(base&& tree) : base(std::move(tree)) {}
+};
+}  // namespace s21
+
+template <typename Key, typename T, typename compare>
+const T& s21::persistent_map<Key, T, compare>::at(const Key& key) const {
+  const_iterator it = find(key);
+  if (it == this->cend()) {
+    throw std::out_of_range("persistent_map::at");
+  }
+  return it->second;
+}
+
+#endif
@@ -3,20 +3,36 @@
 
 #include <vector>
 
+#include "btree/btree.h"
+#include "eytzinger/eytzinger_tree.h"
 #include "red_black_tree/rb_tree.h"
 
 namespace s21 {
-template <typename data_type, typename compare = std::less<data_type>>
-class set : public rb_tree<data_type, compare> {
-  using base = rb_tree<data_type, compare>;
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+class frozen_set;
+
+template <typename data_type, typename compare = std::less<data_type>,
+          typename allocator = pool_allocator<data_type>,
+          typename options = tree_options<>>
+class set : public tree_base<data_type, compare, allocator, options> {
+  using base = tree_base<data_type, compare, allocator, options>;
 
  public:
   using iterator = typename base::iterator;
   using const_iterator = typename base::const_iterator;
+  using node_type = typename base::node_handle;
+  using insert_return_type = typename base::insert_return_type;
 
   set() : base() {}
+  explicit set(const allocator &alloc) : base(alloc) {}
   set(std::initializer_list<data_type> const &items);
+  template <typename input_iterator,
+            typename = typename std::iterator_traits<
+                input_iterator>::iterator_category>
+  set(input_iterator first, input_iterator last) : base(first, last) {}
   set(const set &other) : base(other) {}
+  set(const set &other, execution policy) : base(other, policy) {}
   set(set &&other) noexcept : base(std::move(other)) {}
   ~set() = default;
   set &operator=(set &&other) noexcept;
@@ -31,6 +47,19 @@ class set : public rb_tree<data_type, compare> {
     return base::find(value);
   }
 
+  // итераторы найденных элементов или end() в порядке ключей; поиски
+  // идут группами вперемешку, чтобы промахи кэша перекрывались
+  template <typename key_iterator, typename output_iterator>
+  output_iterator find_many(key_iterator first, key_iterator last,
+                            output_iterator out) {
+    return base::find_many(first, last, out);
+  }
+  template <typename key_iterator, typename output_iterator>
+  output_iterator find_many(key_iterator first, key_iterator last,
+                            output_iterator out) const {
+    return base::find_many(first, last, out);
+  }
+
   bool empty() const noexcept { return base::empty(); }
   size_t size() const noexcept { return base::size(); }
   size_t max_size() const noexcept { return base::max_size(); }
@@ -39,28 +68,142 @@ class set : public rb_tree<data_type, compare> {
   std::pair<iterator, bool> insert(const data_type &value) {
     return this->insert_data(value);
   }
+  std::pair<iterator, bool> insert(data_type &&value) {
+    return this->insert_unique(std::move(value));
+  }
+  iterator insert(iterator hint, const data_type &value) {
+    return this->insert_hint(hint, value);
+  }
+  iterator insert(iterator hint, data_type &&value) {
+    return this->insert_hint(hint, std::move(value));
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    return this->emplace_data(std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  iterator emplace_hint(iterator hint, Args &&...args) {
+    return this->emplace_hint_data(hint, std::forward<Args>(args)...);
+  }
+  insert_return_type insert(node_type &&handle) {
+    return this->insert_handle(std::move(handle));
+  }
   void erase(iterator pos) { base::erase(pos); }
+  iterator erase(iterator first, iterator last) {
+    return base::erase(first, last);
+  }
+  size_t erase(const data_type &value) { return base::erase(value); }
+  node_type extract(iterator pos) { return base::extract(pos); }
+  node_type extract(const data_type &key) {
+    return base::extract(base::find(key));
+  }
   void swap(set &other) noexcept { base::swap(other); }
   void merge(set &other) { base::merge(other); }
+  // элементы не меньше key переезжают в возвращаемый set
+  set split(const data_type &key) {
+    set right(this->get_allocator());
+    this->split_into(key, right);
+    return right;
+  }
+  void join(const data_type &pivot, set &right) { base::join(pivot, right); }
+  void join(set &right) { base::join(right); }
   bool contains(const data_type &key) const {
     return this->find(key) != this->cend();
   }
 
   template <typename... Args>
   std::vector<std::pair<iterator, bool>> insert_many(Args &&...args);
+
+  // неизменяемая копия в раскладке Эйтцингера для частых чтений
+  frozen_set<data_type, compare, allocator, options> freeze() const {
+    return frozen_set<data_type, compare, allocator, options>(*this);
+  }
 };
-}  // namespace s21
 
-template <typename data_type, typename compare>
-s21::set<data_type, compare>::set(
-    std::initializer_list<data_type> const &items) {
-  for (auto &item : items) {
-    this->insert_data(item);
+// Снимок set только для чтения: поиск без указателей по непрерывному
+// массиву; thaw() возвращает изменяемый set
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+class frozen_set : public eytzinger_tree<data_type, compare> {
+  using base = eytzinger_tree<data_type, compare>;
+
+ public:
+  using iterator = typename base::iterator;
+  using const_iterator = typename base::const_iterator;
+
+  frozen_set() : base() {}
+  explicit frozen_set(const set<data_type, compare, allocator, options> &source)
+      : base(source.cbegin(), source.cend(), source.size()) {}
+
+  size_t count(const data_type &key) const {
+    return this->contains(key) ? 1 : 0;
+  }
+  std::pair<const_iterator, const_iterator> equal_range(
+      const data_type &value) const {
+    return {this->lower_bound(value), this->upper_bound(value)};
   }
+  set<data_type, compare, allocator, options> thaw() const {
+    return set<data_type, compare, allocator, options>(this->begin(),
+                                                        this->end());
+  }
+};
+
+// Теоретико-множественные операции над упорядоченными обходами
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+set<data_type, compare, allocator, options> set_union(
+    const set<data_type, compare, allocator, options> &lhs,
+    const set<data_type, compare, allocator, options> &rhs,
+    execution policy = execution::sequential) {
+  set<data_type, compare, allocator, options> result;
+  result.assign_union(lhs, rhs, policy);
+  return result;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+set<data_type, compare, allocator, options> set_intersection(
+    const set<data_type, compare, allocator, options> &lhs,
+    const set<data_type, compare, allocator, options> &rhs,
+    execution policy = execution::sequential) {
+  set<data_type, compare, allocator, options> result;
+  result.assign_intersection(lhs, rhs, policy);
+  return result;
+}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+set<data_type, compare, allocator, options> set_difference(
+    const set<data_type, compare, allocator, options> &lhs,
+    const set<data_type, compare, allocator, options> &rhs,
+    execution policy = execution::sequential) {
+  set<data_type, compare, allocator, options> result;
+  result.assign_difference(lhs, rhs, policy);
+  return result;
 }
 
-template <typename data_type, typename compare>
-s21::set<data_type, compare> &s21::set<data_type, compare>::operator=(
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+set<data_type, compare, allocator, options> set_symmetric_difference(
+    const set<data_type, compare, allocator, options> &lhs,
+    const set<data_type, compare, allocator, options> &rhs,
+    execution policy = execution::sequential) {
+  set<data_type, compare, allocator, options> result;
+  result.assign_symmetric_difference(lhs, rhs, policy);
+  return result;
+}
+}  // namespace s21
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+s21::set<data_type, compare, allocator, options>::set(
+    std::initializer_list<data_type> const &items)
+    : base(items.begin(), items.end()) {}
+
+template <typename data_type, typename compare, typename allocator,
+          typename options>
+s21::set<data_type, compare, allocator, options> &
+s21::set<data_type, compare, allocator, options>::operator=(
     set &&other) noexcept {
   if (this != &other) {
     base::operator=(std::move(other));
@@ -68,12 +211,17 @@ s21::set<data_type, compare> &s21::set<data_type, compare>::operator=(
   return *this;
 }
 
-template <typename data_type, typename compare>
+template <typename data_type, typename compare, typename allocator,
+          typename options>
 template <typename... Args>
-std::vector<std::pair<typename s21::set<data_type, compare>::iterator, bool>>
-s21::set<data_type, compare>::insert_many(Args &&...args) {
+std::vector<std::pair<
+    typename s21::set<data_type, compare, allocator, options>::iterator, bool>>
+s21::set<data_type, compare, allocator, options>::insert_many(Args &&...args) {
+  // итераторы ранних вставок должны пережить следующие вставки
+  static_assert(options::stable_iterators,
+                "insert_many needs a backend with stable iterators");
   std::vector<std::pair<iterator, bool>> results;
-  (results.emplace_back(this->insert_data(std::forward<Args>(args))), ...);
+  (results.emplace_back(this->insert(std::forward<Args>(args))), ...);
   return results;
 }
 
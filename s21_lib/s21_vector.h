@@ -3,7 +3,9 @@
 
 #include <stddef.h>  // для size_t
 
+#include <algorithm>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <stdexcept>  // для исключений
 
@@ -36,6 +38,7 @@ class vector {
   void shrink_to_fit();
   void clear();
   iterator insert(iterator pos, const_reference value);
+  iterator insert(iterator pos, value_type &&value);
   void erase(iterator pos);
 
   ///////
@@ -44,9 +47,11 @@ class vector {
   const_reference front();
   const_reference back();
   iterator data();
+  const_iterator data() const { return data_; }
   ///////
 
   void push_back(const_reference value);
+  void push_back(value_type &&value);
   void pop_back();
   size_type max_size();
   void swap(vector &other);
@@ -57,9 +62,11 @@ class vector {
   template <typename... Args>
   void insert_many_back(Args &&...args);
 
-  size_type size();  // Размер
-  iterator begin();  // Начало
+  size_type size() const;  // Размер
+  iterator begin();        // Начало
   iterator end();
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + count_; }
 
  private:
   size_type capacity_;
@@ -122,7 +129,7 @@ s21::vector<T>::vector(const vector &v) {
   this->count_ = v.count_;
   data_ = allocator_.allocate(this->count_);
   std::uninitialized_copy(v.data_, v.data_ + v.count_, data_);
-  capacity_ = v.capacity_;
+  capacity_ = v.count_;
 }
 
 template <typename T>
@@ -146,7 +153,7 @@ s21::vector<T>::~vector() {
       data_[i].~T();
     }
     // Освобождаем выделенную память
-    allocator_.deallocate(data_, count_);
+    allocator_.deallocate(data_, capacity_);
   }
   capacity_ = 0;
 }
@@ -160,13 +167,13 @@ s21::vector<T> &s21::vector<T>::operator=(const vector<T> &v) {
         // allocator_.destroy(data_ + i);
         data_[i].~T();
       }
-      allocator_.deallocate(data_, count_);
+      allocator_.deallocate(data_, capacity_);
     }
     // Выделяем новую память и копируем элементы
     count_ = v.count_;
     data_ = allocator_.allocate(count_);
     std::uninitialized_copy(v.data_, v.data_ + count_, data_);
-    capacity_ = v.capacity_;  // Копирование capacity из v
+    capacity_ = count_;  // выделено ровно count_ элементов
   }
   return *this;
 }
@@ -180,7 +187,7 @@ s21::vector<T> &s21::vector<T>::operator=(vector<T> &&v) {
         // allocator_.destroy(data_ + i);
         data_[i].~T();
       }
-      allocator_.deallocate(data_, count_);
+      allocator_.deallocate(data_, capacity_);
     }
 
     // Переносим ресурсы
@@ -226,9 +233,10 @@ void s21::vector<T>::shrink_to_fit() {
     pointer new_data = allocator_.allocate(
         count_);  // Выделение памяти точно под количество элементов
 
-    for (size_type i = 0; i < count_; ++i) {
-      new_data[i] = std::move(data_[i]);  // Присваивание элементов
-    }
+    // Элементы переносятся в еще не построенную память
+    std::uninitialized_copy(std::make_move_iterator(data_),
+                            std::make_move_iterator(data_ + count_),
+                            new_data);
 
     for (size_type i = 0; i < count_; ++i) {
       data_[i].~T();
@@ -252,6 +260,16 @@ void s21::vector<T>::clear() {
 template <typename T>
 typename s21::vector<T>::iterator s21::vector<T>::insert(
     iterator pos, const_reference value) {
+  // value может лежать в самом векторе, копия переживет перевыделение
+  value_type copy(value);
+  return insert(pos, std::move(copy));
+}
+
+// Последний элемент переезжает в свободную ячейку за концом, остальные
+// сдвигаются присваиванием; в неинициализированную память не пишем.
+template <typename T>
+typename s21::vector<T>::iterator s21::vector<T>::insert(
+    iterator pos, value_type &&value) {
   size_type index = pos - begin();
 
   if (count_ == capacity_) {
@@ -259,15 +277,18 @@ typename s21::vector<T>::iterator s21::vector<T>::insert(
   }
 
   iterator new_pos = begin() + index;
-
-  for (iterator it = end(); it != new_pos; --it) {
-    *it = *(it - 1);
+  if (new_pos == end()) {
+    new (end()) T(std::move(value));
+  } else {
+    new (end()) T(std::move(*(end() - 1)));
+    std::move_backward(new_pos, end() - 1, end());
+    *new_pos = std::move(value);
   }
-  *new_pos = value;
   ++count_;
 
   return new_pos;
 }
+
 template <typename T>
 void s21::vector<T>::erase(iterator pos) {
   // Проверяем, действителен ли итератор
@@ -278,10 +299,8 @@ void s21::vector<T>::erase(iterator pos) {
   // Рассчитываем индекс удаляемого элемента
   size_type index = pos - data_;
 
-  // Вызываем деструктор для удаляемого элемента
-  (data_ + index)->~T();
-
-  // Сдвигаем все последующие элементы на одну позицию влево
+  // Сдвигаем все последующие элементы на одну позицию влево поверх
+  // удаляемого
   for (size_type i = index; i < count_ - 1; ++i) {
     data_[i] = std::move(data_[i + 1]);
   }
@@ -306,6 +325,15 @@ void s21::vector<T>::push_back(const_reference value) {
   count_++;
 }
 
+template <typename T>
+void s21::vector<T>::push_back(value_type &&value) {
+  if (count_ >= capacity_) {
+    reserve(capacity_ > 0 ? capacity_ * 2 : 1);
+  }
+  new (data_ + count_) T(std::move(value));
+  count_++;
+}
+
 template <typename T>
 void s21::vector<T>::pop_back() {
   if (count_ != 0) {
@@ -367,7 +395,7 @@ void s21::vector<T>::insert_many_back(Args &&...args) {
 
 ///////////////////
 template <typename T>
-typename s21::vector<T>::size_type s21::vector<T>::size() {
+typename s21::vector<T>::size_type s21::vector<T>::size() const {
   return count_;
 }
 
@@ -0,0 +1,127 @@
+#include "../s21_lib/s21_concurrent_map.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(concurrent_map_test_eq, single_thread_operations) {
+  s21::concurrent_map<int, std::string> s21_map({{1, "one"}, {2, "two"}}, 3);
+  std::map<int, std::string> std_map = {{1, "one"}, {2, "two"}};
+  EXPECT_EQ(s21_map.shard_count(), 3u);
+  EXPECT_LT(s21_map.shard_of(2), 3u);
+
+  EXPECT_EQ(s21_map.insert(3, "three"), std_map.insert({3, "three"}).second);
+  EXPECT_EQ(s21_map.insert({1, "uno"}), std_map.insert({1, "uno"}).second);
+  EXPECT_EQ(*s21_map.find(1), "one");
+  EXPECT_FALSE(s21_map.find(7).has_value());
+  EXPECT_TRUE(s21_map.contains(3));
+
+  EXPECT_FALSE(s21_map.insert_or_assign(3, "drei"));
+  std_map[3] = "drei";
+  EXPECT_TRUE(s21_map.update(2, [](std::string &value) { value += "!"; }));
+  std_map[2] += "!";
+  EXPECT_FALSE(s21_map.update(9, [](std::string &value) { value.clear(); }));
+  EXPECT_EQ(s21_map.erase(1), std_map.erase(1));
+  EXPECT_EQ(s21_map.erase(1), 0u);
+  EXPECT_EQ(s21_map.size(), std_map.size());
+
+  s21_map.clear();
+  EXPECT_TRUE(s21_map.empty());
+}
+
+TEST(concurrent_map_test_eq, ordered_view_merges_shards) {
+  for (size_t shards : {1, 2, 5, 16}) {
+    s21::concurrent_map<int, int> s21_map(shards);
+    std::map<int, int> std_map;
+    for (int i = 0; i < 300; ++i) {
+      int key = (i * 37) % 211;
+      s21_map.insert(key, i);
+      std_map.insert({key, i});
+    }
+    auto view = s21_map.ordered();
+    EXPECT_EQ(view.size(), std_map.size());
+    ASSERT_NE(view.find(37), nullptr);
+    EXPECT_EQ(*view.find(37), std_map.at(37));
+    EXPECT_FALSE(view.contains(212));
+    auto expected = std_map.begin();
+    for (const auto &item : view) {
+      ASSERT_NE(expected, std_map.end());
+      EXPECT_EQ(item.first, expected->first);
+      EXPECT_EQ(item.second, expected->second);
+      ++expected;
+    }
+    EXPECT_EQ(expected, std_map.end());
+  }
+  s21::concurrent_map<int, int> empty_map(4);
+  auto empty_view = empty_map.ordered();
+  EXPECT_EQ(empty_view.begin(), empty_view.end());
+}
+
+TEST(concurrent_map_test, parallel_writers_and_readers) {
+  const int threads = 4;
+  const int per_thread = 2000;
+  s21::concurrent_map<int, int> s21_map(8);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&s21_map, t] {
+      for (int i = 0; i < per_thread; ++i) {
+        s21_map.insert(i * threads + t, t);
+        s21_map.find(i * threads + (t + 1) % threads);
+      }
+    });
+  }
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&s21_map] {
+      for (int i = 0; i < per_thread; ++i) {
+        s21_map.update(i, [](int &value) { value += 100; });
+      }
+    });
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+
+  EXPECT_EQ(s21_map.size(), static_cast<size_t>(threads * per_thread));
+  int previous = -1;
+  int count = 0;
+  for (const auto &item : s21_map.ordered()) {
+    EXPECT_LT(previous, item.first);
+    EXPECT_EQ(item.second % 100, item.first % threads);
+    previous = item.first;
+    ++count;
+  }
+  EXPECT_EQ(count, threads * per_thread);
+}
+
+TEST(concurrent_map_test, writers_on_separate_shards) {
+  const int threads = 4;
+  const int per_thread = 3000;
+  s21::concurrent_map<int, int> s21_map(threads);
+  std::vector<std::thread> workers;
+  // каждый поток пишет только в свой шард
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&s21_map, t] {
+      int inserted = 0;
+      for (int key = 0; inserted < per_thread; ++key) {
+        if (s21_map.shard_of(key) != static_cast<size_t>(t)) continue;
+        s21_map.insert(key, t);
+        if (inserted % 3 == 0) s21_map.erase(key);
+        ++inserted;
+      }
+    });
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+
+  const int kept = per_thread - per_thread / 3;
+  EXPECT_EQ(s21_map.size(), static_cast<size_t>(threads * kept));
+  std::vector<std::pair<int, int>> items;
+  for (const auto &item : s21_map.ordered()) items.push_back(item);
+  for (const auto &item : items) {
+    EXPECT_EQ(s21_map.shard_of(item.first), static_cast<size_t>(item.second));
+  }
+}
@@ -0,0 +1,124 @@
+#include "../s21_lib/s21_flat_map.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+
+template <typename flat, typename ordered>
+bool same_pairs(const flat &lhs, const ordered &rhs) {
+  return lhs.size() == rhs.size() &&
+         std::equal(lhs.cbegin(), lhs.cend(), rhs.begin(),
+                    [](const auto &a, const auto &b) {
+                      return a.first == b.first && a.second == b.second;
+                    });
+}
+
+TEST(flat_map_test_eq, constructors_and_access) {
+  s21::flat_map<int, std::string> s21_map = {{2, "two"}, {1, "one"},
+                                             {2, "second"}};
+  std::map<int, std::string> std_map = {{2, "two"}, {1, "one"},
+                                        {2, "second"}};
+  EXPECT_TRUE(same_pairs(s21_map, std_map));
+  EXPECT_EQ(s21_map.at(2), std_map.at(2));
+  EXPECT_THROW(s21_map.at(3), std::out_of_range);
+  const s21::flat_map<int, std::string> &const_map = s21_map;
+  EXPECT_EQ(const_map.at(1), "one");
+  EXPECT_THROW(const_map.at(0), std::out_of_range);
+
+  s21_map[5] = "five";
+  std_map[5] = "five";
+  s21_map[1] += "!";
+  std_map[1] += "!";
+  EXPECT_TRUE(same_pairs(s21_map, std_map));
+
+  s21::flat_map<int, std::string> s21_copy(s21_map);
+  s21::flat_map<int, std::string> s21_moved(std::move(s21_copy));
+  EXPECT_TRUE(same_pairs(s21_moved, std_map));
+  s21_copy = s21_moved;
+  EXPECT_TRUE(same_pairs(s21_copy, std_map));
+}
+
+TEST(flat_map_test_eq, insert_variants) {
+  s21::flat_map<std::string, int> s21_map;
+  std::map<std::string, int> std_map;
+  EXPECT_EQ(s21_map.insert({"a", 1}).second, std_map.insert({"a", 1}).second);
+  EXPECT_EQ(s21_map.insert("a", 2).second, std_map.insert({"a", 2}).second);
+  EXPECT_EQ(s21_map.try_emplace("c", 3).second,
+            std_map.try_emplace("c", 3).second);
+  EXPECT_EQ(s21_map.emplace("b", 2).second, std_map.emplace("b", 2).second);
+  EXPECT_EQ(s21_map.insert_or_assign({"a", 7}).second,
+            std_map.insert_or_assign("a", 7).second);
+  EXPECT_EQ(s21_map.insert(s21_map.end(), {"d", 4})->first, "d");
+  std_map.insert({"d", 4});
+  EXPECT_EQ(s21_map.emplace_hint(s21_map.begin(), "0", 0)->second, 0);
+  std_map.emplace("0", 0);
+  EXPECT_TRUE(same_pairs(s21_map, std_map));
+  EXPECT_TRUE(s21_map.contains("b"));
+  EXPECT_EQ(s21_map.count("z"), 0u);
+}
+
+TEST(flat_map_test_eq, random_operations_match_std) {
+  std::mt19937 generator(21);
+  std::uniform_int_distribution<int> key(0, 200);
+  s21::flat_map<int, int> s21_map;
+  std::map<int, int> std_map;
+  for (int step = 0; step < 2000; ++step) {
+    int value = key(generator);
+    if (step % 3 == 0) {
+      EXPECT_EQ(s21_map.erase(value), std_map.erase(value));
+    } else {
+      EXPECT_EQ(s21_map.insert({value, step}).second,
+                std_map.insert({value, step}).second);
+    }
+    int probe = key(generator);
+    EXPECT_EQ(s21_map.lower_bound(probe) - s21_map.begin(),
+              std::distance(std_map.begin(), std_map.lower_bound(probe)));
+    EXPECT_EQ(s21_map.upper_bound(probe) - s21_map.begin(),
+              std::distance(std_map.begin(), std_map.upper_bound(probe)));
+  }
+  EXPECT_TRUE(same_pairs(s21_map, std_map));
+}
+
+TEST(flat_map_test_eq, insert_many_and_merge) {
+  s21::flat_map<int, std::string> s21_map = {{3, "c"}};
+  auto results = s21_map.insert_many(std::make_pair(2, std::string("b")),
+                                     std::make_pair(3, std::string("x")),
+                                     std::make_pair(1, std::string("a")),
+                                     std::make_pair(2, std::string("y")));
+  std::map<int, std::string> std_map = {{1, "a"}, {2, "b"}, {3, "c"}};
+  EXPECT_TRUE(same_pairs(s21_map, std_map));
+  ASSERT_EQ(results.size(), 4u);
+  EXPECT_EQ(results[0].first->second, "b");
+  EXPECT_TRUE(results[0].second);
+  EXPECT_EQ(results[1].first->second, "c");
+  EXPECT_FALSE(results[1].second);
+  EXPECT_TRUE(results[2].second);
+  EXPECT_EQ(results[3].first, results[0].first);
+  EXPECT_FALSE(results[3].second);
+
+  s21::flat_map<int, std::string> s21_other = {{0, "z"}, {3, "w"}};
+  s21_map.merge(s21_other);
+  std_map.insert({0, "z"});
+  EXPECT_TRUE(same_pairs(s21_map, std_map));
+  EXPECT_EQ(s21_other.size(), 1u);
+  EXPECT_EQ(s21_other.at(3), "w");
+}
+
+TEST(flat_map_test_eq, erase_range_and_equal_range) {
+  s21::flat_map<int, int> s21_map = {{1, 1}, {2, 4}, {3, 9}, {4, 16}};
+  std::map<int, int> std_map = {{1, 1}, {4, 16}};
+  auto range = s21_map.equal_range(2);
+  EXPECT_EQ(range.second - range.first, 1);
+  auto next = s21_map.erase(s21_map.find(2), s21_map.find(4));
+  EXPECT_EQ(next->first, 4);
+  EXPECT_TRUE(same_pairs(s21_map, std_map));
+  s21_map.erase(s21_map.begin());
+  EXPECT_EQ(s21_map.size(), 1u);
+  s21::flat_map<int, int> s21_other;
+  s21_map.swap(s21_other);
+  EXPECT_TRUE(s21_map.empty());
+  EXPECT_EQ(s21_other.at(4), 16);
+}
@@ -0,0 +1,140 @@
+#include "../s21_lib/s21_flat_set.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+TEST(flat_set_test_eq, constructors) {
+  s21::flat_set<int> s21_empty;
+  s21::flat_set<int> s21_set = {5, 1, 4, 1, 3, 5};
+  std::set<int> std_set = {5, 1, 4, 1, 3, 5};
+  EXPECT_TRUE(s21_empty.empty());
+  EXPECT_EQ(s21_set.size(), std_set.size());
+  EXPECT_TRUE(std::equal(s21_set.begin(), s21_set.end(), std_set.begin(),
+                         std_set.end()));
+
+  std::vector<int> items = {9, 7, 9, 8};
+  s21::flat_set<int> s21_range(items.begin(), items.end());
+  std::set<int> std_range(items.begin(), items.end());
+  EXPECT_TRUE(std::equal(s21_range.begin(), s21_range.end(),
+                         std_range.begin(), std_range.end()));
+
+  s21::flat_set<int> s21_copy(s21_set);
+  s21::flat_set<int> s21_moved(std::move(s21_copy));
+  EXPECT_TRUE(s21_copy.empty());
+  EXPECT_TRUE(std::equal(s21_moved.cbegin(), s21_moved.cend(),
+                         std_set.begin(), std_set.end()));
+  s21_copy = s21_range;
+  EXPECT_EQ(s21_copy.size(), std_range.size());
+}
+
+TEST(flat_set_test_eq, insert_find_and_erase) {
+  s21::flat_set<std::string> s21_set;
+  std::set<std::string> std_set;
+  for (const char *word : {"pear", "apple", "fig", "apple", "kiwi", "lime"}) {
+    auto s21_result = s21_set.insert(word);
+    auto std_result = std_set.insert(word);
+    EXPECT_EQ(s21_result.second, std_result.second);
+    EXPECT_EQ(*s21_result.first, *std_result.first);
+  }
+  EXPECT_TRUE(s21_set.contains("fig"));
+  EXPECT_FALSE(s21_set.contains("plum"));
+  EXPECT_EQ(s21_set.count("kiwi"), 1u);
+  EXPECT_EQ(s21_set.find("plum"), s21_set.end());
+
+  s21_set.erase(s21_set.find("fig"));
+  std_set.erase("fig");
+  EXPECT_EQ(s21_set.erase("lime"), std_set.erase("lime"));
+  EXPECT_EQ(s21_set.erase("lime"), 0u);
+  EXPECT_TRUE(std::equal(s21_set.begin(), s21_set.end(), std_set.begin(),
+                         std_set.end()));
+
+  auto position = s21_set.erase(s21_set.begin(), s21_set.begin() + 1);
+  EXPECT_EQ(*position, "kiwi");
+  s21_set.clear();
+  EXPECT_TRUE(s21_set.empty());
+}
+
+TEST(flat_set_test_eq, bounds_match_std) {
+  std::mt19937 generator(20);
+  std::uniform_int_distribution<int> value(0, 300);
+  for (int size : {0, 1, 2, 3, 7, 16, 100}) {
+    std::set<int> std_set;
+    while (static_cast<int>(std_set.size()) < size) {
+      std_set.insert(value(generator) * 2);
+    }
+    s21::flat_set<int> s21_set(std_set.begin(), std_set.end());
+    for (int key = -1; key <= 602; ++key) {
+      EXPECT_EQ(s21_set.lower_bound(key) - s21_set.begin(),
+                std::distance(std_set.begin(), std_set.lower_bound(key)));
+      EXPECT_EQ(s21_set.upper_bound(key) - s21_set.begin(),
+                std::distance(std_set.begin(), std_set.upper_bound(key)));
+      auto range = s21_set.equal_range(key);
+      EXPECT_EQ(range.second - range.first,
+                static_cast<long>(std_set.count(key)));
+    }
+  }
+}
+
+TEST(flat_set_test_eq, hint_and_emplace) {
+  s21::flat_set<int> s21_set;
+  std::set<int> std_set;
+  for (int i = 0; i < 50; ++i) {
+    s21_set.insert(s21_set.end(), i * 3 % 50);
+    std_set.insert(i * 3 % 50);
+  }
+  EXPECT_EQ(*s21_set.insert(s21_set.begin(), 10), 10);
+  EXPECT_EQ(*s21_set.emplace_hint(s21_set.begin(), 60), 60);
+  std_set.insert(60);
+  EXPECT_FALSE(s21_set.emplace(60).second);
+  EXPECT_TRUE(std::equal(s21_set.begin(), s21_set.end(), std_set.begin(),
+                         std_set.end()));
+}
+
+TEST(flat_set_test_eq, insert_many_sorts_and_merges_once) {
+  s21::flat_set<std::string> s21_set = {"b", "d"};
+  auto results = s21_set.insert_many("c", "a", "d", "c", "e");
+  std::set<std::string> std_set = {"a", "b", "c", "d", "e"};
+  EXPECT_TRUE(std::equal(s21_set.begin(), s21_set.end(), std_set.begin(),
+                         std_set.end()));
+
+  std::vector<std::string> values = {"c", "a", "d", "c", "e"};
+  std::vector<bool> inserted = {true, true, false, false, true};
+  ASSERT_EQ(results.size(), values.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(*results[i].first, values[i]);
+    EXPECT_EQ(results[i].second, inserted[i]);
+  }
+}
+
+TEST(flat_set_test_eq, merge_swap_and_erase_if) {
+  s21::flat_set<int> s21_set = {1, 3, 5};
+  s21::flat_set<int> s21_other = {2, 3, 6};
+  s21_set.merge(s21_other);
+  std::vector<int> merged = {1, 2, 3, 5, 6};
+  EXPECT_TRUE(std::equal(s21_set.begin(), s21_set.end(), merged.begin(),
+                         merged.end()));
+  ASSERT_EQ(s21_other.size(), 1u);
+  EXPECT_EQ(*s21_other.begin(), 3);
+
+  EXPECT_EQ(erase_if(s21_set, [](int value) { return value % 2 == 0; }), 2u);
+  std::vector<int> odd = {1, 3, 5};
+  EXPECT_TRUE(
+      std::equal(s21_set.begin(), s21_set.end(), odd.begin(), odd.end()));
+
+  s21_set.swap(s21_other);
+  EXPECT_EQ(s21_set.size(), 1u);
+  EXPECT_EQ(s21_other.size(), 3u);
+}
+
+TEST(flat_set_test_eq, custom_comparator) {
+  s21::flat_set<int, std::greater<int>> s21_set = {1, 4, 2, 8};
+  std::set<int, std::greater<int>> std_set = {1, 4, 2, 8};
+  EXPECT_TRUE(std::equal(s21_set.begin(), s21_set.end(), std_set.begin(),
+                         std_set.end()));
+  EXPECT_EQ(*s21_set.lower_bound(3), *std_set.lower_bound(3));
+}
@@ -2,6 +2,12 @@
 
 #include <gtest/gtest.h>
 
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
 template <typename iterator1, typename iterator2>
 bool containers_equal(iterator1 begin1, iterator1 end1, iterator2 begin2,
                       iterator2 end2) {
@@ -201,11 +207,22 @@ TEST(map_test_eq, noempty_method) {
   EXPECT_EQ(s21_map.empty(), std_map.empty());
 }
 
+// узел map: значение и три указателя, цвет хранится в бите указателя
+struct map_node_layout {
+  std::pair<int, std::string> data;
+  void *links[3];
+};
+
 TEST(map_test_eq, max_size_method) {
   s21::map<int, std::string> s21_map;
   std::map<int, std::string> std_map;
+  std::allocator<map_node_layout> node_allocator;
 
-  EXPECT_EQ(s21_map.max_size(), std_map.max_size());
+  EXPECT_EQ(s21_map.max_size(),
+            std::allocator_traits<std::allocator<map_node_layout>>::max_size(
+                node_allocator));
+  // у std::map в узле еще поле цвета, поэтому его предел меньше
+  EXPECT_GT(s21_map.max_size(), std_map.max_size());
 }
 
 TEST(map_test_eq, clear_method) {
@@ -231,6 +248,22 @@ TEST(map_test_eq, clear_method) {
                                std_map.end()));
 }
 
+TEST(map_test, clear_and_reuse) {
+  s21::map<int, std::string> s21_map;
+  for (int i = 0; i < 1000; ++i) {
+    s21_map.insert(i, std::to_string(i));
+  }
+  s21_map.clear();
+
+  EXPECT_TRUE(s21_map.empty());
+  EXPECT_TRUE(s21_map.begin() == s21_map.end());
+
+  s21_map.insert(7, "seven");
+  EXPECT_EQ(s21_map.size(), 1U);
+  EXPECT_EQ(s21_map.at(7), "seven");
+  EXPECT_TRUE(s21_map.is_balanced());
+}
+
 TEST(map_test, insert_method) {
   s21::map<int, std::string> map;
 
@@ -368,4 +401,477 @@ TEST(map_insert_many_test, basic_insertion) {
   EXPECT_TRUE(my_map.contains(1));
   EXPECT_TRUE(my_map.contains(2));
   EXPECT_TRUE(my_map.contains(3));
-}
\ No newline at end of file
+}
+TEST(map_test_eq, range_constructor_sorted) {
+  std::map<int, std::string> std_map;
+  for (int i = 0; i < 300; ++i) std_map[i] = std::to_string(i);
+  s21::map<int, std::string> s21_map(std_map.begin(), std_map.end());
+
+  EXPECT_EQ(s21_map.size(), std_map.size());
+  EXPECT_TRUE(s21_map.is_balanced());
+  EXPECT_TRUE(containers_equal(s21_map.begin(), s21_map.end(), std_map.begin(),
+                               std_map.end()));
+  EXPECT_EQ(s21_map.at(150), "150");
+}
+
+TEST(map_test_eq, insert_with_hint) {
+  s21::map<int, std::string> s21_map;
+  std::map<int, std::string> std_map;
+  for (int i = 0; i < 100; ++i) {
+    s21_map.insert(s21_map.end(), {i, std::to_string(i)});
+    std_map.insert(std_map.end(), {i, std::to_string(i)});
+  }
+  auto it = s21_map.insert(s21_map.find(10), {10, "ten"});
+  EXPECT_EQ(it->second, "10");
+  s21_map.emplace_hint(s21_map.begin(), -5, "minus five");
+  std_map.emplace_hint(std_map.begin(), -5, "minus five");
+
+  EXPECT_TRUE(s21_map.is_balanced());
+  EXPECT_TRUE(containers_equal(s21_map.begin(), s21_map.end(), std_map.begin(),
+                               std_map.end()));
+}
+
+struct counted_value {
+  static int default_constructed;
+  counted_value() { ++default_constructed; }
+  explicit counted_value(int value) : value_(value) {}
+  int value_ = 0;
+};
+int counted_value::default_constructed = 0;
+
+TEST(map_test, lookup_does_not_build_value) {
+  s21::map<int, counted_value> s21_map;
+  for (int i = 0; i < 10; ++i) {
+    s21_map.insert(i * 2, counted_value(i));
+  }
+  const s21::map<int, counted_value> &const_map = s21_map;
+  counted_value::default_constructed = 0;
+
+  EXPECT_EQ(s21_map.find(4)->second.value_, 2);
+  EXPECT_TRUE(const_map.find(5) == const_map.cend());
+  EXPECT_TRUE(s21_map.contains(18));
+  EXPECT_EQ(s21_map.count(3), 0U);
+  EXPECT_EQ(s21_map.at(6).value_, 3);
+  EXPECT_EQ(const_map.at(8).value_, 4);
+  EXPECT_THROW(s21_map.at(7), std::out_of_range);
+  EXPECT_EQ(s21_map.lower_bound(5)->first, 6);
+  EXPECT_EQ(const_map.lower_bound(6)->first, 6);
+  EXPECT_TRUE(s21_map.lower_bound(100) == s21_map.end());
+  EXPECT_EQ(s21_map[10].value_, 5);
+  EXPECT_EQ(counted_value::default_constructed, 0);
+
+  s21_map[11];
+  EXPECT_EQ(counted_value::default_constructed, 1);
+  EXPECT_TRUE(s21_map.is_balanced());
+}
+
+struct no_default_value {
+  explicit no_default_value(int value) : value_(value) {}
+  int value_;
+};
+
+TEST(map_test, lookup_without_default_constructor) {
+  s21::map<std::string, no_default_value> s21_map;
+  s21_map.insert("one", no_default_value(1));
+  s21_map.insert("two", no_default_value(2));
+
+  EXPECT_EQ(s21_map.at("two").value_, 2);
+  EXPECT_EQ(s21_map.find("one")->second.value_, 1);
+  EXPECT_FALSE(s21_map.contains("three"));
+}
+
+struct copy_counter {
+  static int copies;
+  static int moves;
+  copy_counter() = default;
+  explicit copy_counter(int value) : value_(value) {}
+  copy_counter(const copy_counter &other) : value_(other.value_) { ++copies; }
+  copy_counter(copy_counter &&other) noexcept : value_(other.value_) {
+    ++moves;
+  }
+  copy_counter &operator=(const copy_counter &other) {
+    value_ = other.value_;
+    ++copies;
+    return *this;
+  }
+  int value_ = 0;
+};
+int copy_counter::copies = 0;
+int copy_counter::moves = 0;
+
+TEST(map_test, emplace_and_move_insert) {
+  s21::map<int, copy_counter> s21_map;
+  copy_counter::copies = 0;
+  copy_counter::moves = 0;
+
+  EXPECT_TRUE(s21_map.try_emplace(1, 10).second);
+  EXPECT_TRUE(s21_map.emplace(std::piecewise_construct,
+                              std::forward_as_tuple(2),
+                              std::forward_as_tuple(20))
+                  .second);
+  EXPECT_TRUE(s21_map.insert(std::make_pair(3, copy_counter(30))).second);
+  EXPECT_EQ(s21_map.emplace_hint(s21_map.end(), std::piecewise_construct,
+                                 std::forward_as_tuple(4),
+                                 std::forward_as_tuple(40))
+                ->second.value_,
+            40);
+  EXPECT_EQ(copy_counter::copies, 0);
+
+  EXPECT_FALSE(s21_map.try_emplace(1, 11).second);
+  EXPECT_EQ(s21_map.at(1).value_, 10);
+  EXPECT_FALSE(s21_map.emplace(2, copy_counter(21)).second);
+  EXPECT_EQ(s21_map.at(2).value_, 20);
+
+  copy_counter::copies = 0;
+  copy_counter value(50);
+  EXPECT_TRUE(s21_map.insert(5, value).second);
+  EXPECT_EQ(copy_counter::copies, 1);
+  EXPECT_EQ(s21_map.size(), 5U);
+  EXPECT_TRUE(s21_map.is_balanced());
+}
+
+TEST(map_test, extract_and_insert_node) {
+  s21::map<int, copy_counter> source;
+  s21::map<int, copy_counter> target;
+  for (int i = 0; i < 10; ++i) source.try_emplace(i, i * 10);
+  copy_counter::copies = 0;
+  copy_counter::moves = 0;
+
+  auto handle = source.extract(3);
+  ASSERT_FALSE(handle.empty());
+  copy_counter *address = &handle.mapped();
+  handle.key() = 30;
+  auto result = target.insert(std::move(handle));
+  EXPECT_TRUE(result.inserted);
+  EXPECT_TRUE(result.node.empty());
+  EXPECT_TRUE(handle.empty());
+  EXPECT_EQ(&result.position->second, address);
+  EXPECT_EQ(target.at(30).value_, 30);
+  EXPECT_FALSE(source.contains(3));
+  EXPECT_EQ(copy_counter::copies, 0);
+  EXPECT_EQ(copy_counter::moves, 0);
+
+  auto duplicate = source.extract(source.find(4));
+  duplicate.key() = 30;
+  auto rejected = target.insert(std::move(duplicate));
+  EXPECT_FALSE(rejected.inserted);
+  EXPECT_FALSE(rejected.node.empty());
+  EXPECT_EQ(rejected.position->second.value_, 30);
+  EXPECT_EQ(rejected.node.mapped().value_, 40);
+
+  EXPECT_TRUE(source.extract(100).empty());
+  EXPECT_EQ(source.size(), 8U);
+  EXPECT_EQ(target.size(), 1U);
+  EXPECT_TRUE(source.is_balanced());
+}
+
+TEST(map_test, insert_node_from_other_pool) {
+  s21::map<int, copy_counter> source;
+  s21::map<int, copy_counter> target(
+      s21::pool_allocator<std::pair<int, copy_counter>>::isolated());
+  source.try_emplace(1, 10);
+  copy_counter::copies = 0;
+  copy_counter::moves = 0;
+
+  auto result = target.insert(source.extract(1));
+  EXPECT_TRUE(result.inserted);
+  EXPECT_EQ(target.at(1).value_, 10);
+  EXPECT_EQ(copy_counter::copies, 0);
+  EXPECT_TRUE(source.empty());
+}
+
+TEST(map_test, merge_relinks_nodes) {
+  for (int other_size : {3, 100}) {
+    s21::map<int, std::string> s21_map;
+    s21::map<int, std::string> s21_map2;
+    for (int i = 0; i < 100; ++i) s21_map.try_emplace(i * 2, "a");
+    for (int i = 0; i < other_size; ++i) s21_map2.try_emplace(i * 3, "b");
+    const std::string *address = &s21_map2.find(3)->second;
+    size_t expected = s21_map2.size();
+    s21_map.merge(s21_map2);
+
+    EXPECT_EQ(&s21_map.find(3)->second, address);
+    EXPECT_EQ(s21_map.at(6), "a");
+    EXPECT_EQ(s21_map2.at(6), "b");
+    EXPECT_FALSE(s21_map2.contains(3));
+    EXPECT_EQ(s21_map.size() + s21_map2.size(), 100 + expected);
+    EXPECT_TRUE(s21_map.is_balanced());
+    EXPECT_TRUE(s21_map2.is_balanced());
+  }
+}
+
+TEST(map_test, order_statistics) {
+  s21::map<int, std::string, s21::pair_compare<int, std::string>,
+           s21::pool_allocator<std::pair<int, std::string>>,
+           s21::tree_options<true>>
+      s21_map;
+  for (int i = 0; i < 100; ++i) s21_map.insert(i * 10, std::to_string(i));
+  s21_map.erase(s21_map.find(500));
+  EXPECT_EQ(s21_map.nth(50)->first, 510);
+  EXPECT_EQ(s21_map.rank(510), 50U);
+  EXPECT_EQ(s21_map.rank(505), 50U);
+  EXPECT_EQ(s21_map.count_range(100, 200), 10U);
+  EXPECT_EQ(s21_map.count_range(450, 550), 9U);
+  EXPECT_TRUE(s21_map.is_balanced());
+}
+
+TEST(map_test, bounds_and_equal_range) {
+  s21::map<int, std::string> s21_map = {{1, "a"}, {3, "b"}, {5, "c"}};
+  const auto &const_map = s21_map;
+  EXPECT_EQ(s21_map.upper_bound(3)->first, 5);
+  EXPECT_EQ(const_map.upper_bound(2)->first, 3);
+  EXPECT_TRUE(s21_map.upper_bound(5) == s21_map.end());
+
+  auto range = s21_map.equal_range(3);
+  EXPECT_EQ(range.first->second, "b");
+  EXPECT_EQ(range.second->first, 5);
+  auto missing = const_map.equal_range(4);
+  EXPECT_TRUE(missing.first == missing.second);
+  EXPECT_EQ(missing.first->first, 5);
+}
+
+TEST(map_test, front_back_and_end_decrement) {
+  s21::map<int, std::string> s21_map = {{2, "b"}, {1, "a"}, {3, "c"}};
+  const auto &const_map = s21_map;
+  EXPECT_EQ(s21_map.front().second, "a");
+  EXPECT_EQ(s21_map.back().second, "c");
+  auto last = s21_map.end();
+  --last;
+  EXPECT_EQ(last->first, 3);
+  auto const_last = const_map.cend();
+  --const_last;
+  EXPECT_EQ(const_last->first, 3);
+  s21_map.erase(last);
+  EXPECT_EQ(s21_map.back().first, 2);
+  s21_map.insert(0, "z");
+  EXPECT_EQ(s21_map.begin()->second, "z");
+}
+
+struct pinned_value {
+  explicit pinned_value(int value) : value_(value) {}
+  pinned_value(const pinned_value &) = delete;
+  pinned_value &operator=(const pinned_value &) = delete;
+  pinned_value(pinned_value &&) = default;
+  pinned_value &operator=(pinned_value &&) = delete;
+  int value_;
+};
+
+TEST(map_test, erase_relinks_without_assignment) {
+  s21::map<int, pinned_value> s21_map;
+  for (int i = 0; i < 64; ++i) s21_map.try_emplace(i, i * 2);
+  std::vector<const pinned_value *> addresses;
+  for (int i = 0; i < 64; ++i) addresses.push_back(&s21_map.find(i)->second);
+
+  for (int i = 0; i < 64; i += 3) s21_map.erase(s21_map.find(i));
+  EXPECT_TRUE(s21_map.is_balanced());
+  for (int i = 0; i < 64; ++i) {
+    if (i % 3 == 0) {
+      EXPECT_FALSE(s21_map.contains(i));
+    } else {
+      EXPECT_EQ(&s21_map.find(i)->second, addresses[i]);
+      EXPECT_EQ(s21_map.find(i)->second.value_, i * 2);
+    }
+  }
+}
+
+TEST(map_test_eq, erase_range_key_and_erase_if) {
+  s21::map<int, int> s21_map;
+  std::map<int, int> std_map;
+  for (int i = 0; i < 200; ++i) {
+    s21_map.insert(i, i * i);
+    std_map.emplace(i, i * i);
+  }
+  EXPECT_EQ(s21_map.erase(10), std_map.erase(10));
+  EXPECT_EQ(s21_map.erase(10), 0U);
+  s21_map.erase(s21_map.lower_bound(50), s21_map.lower_bound(150));
+  std_map.erase(std_map.lower_bound(50), std_map.lower_bound(150));
+  auto pred = [](const auto &item) { return item.second % 3 == 0; };
+  size_t expected = 0;
+  for (auto it = std_map.begin(); it != std_map.end();) {
+    it = pred(*it) ? (++expected, std_map.erase(it)) : std::next(it);
+  }
+  EXPECT_EQ(s21::erase_if(s21_map, pred), expected);
+  EXPECT_TRUE(s21_map.is_balanced());
+  EXPECT_TRUE(containers_equal(s21_map.begin(), s21_map.end(),
+                               std_map.begin(), std_map.end()));
+}
+
+TEST(map_test, split_and_join) {
+  s21::map<int, std::string> s21_map;
+  for (int i = 0; i < 300; ++i) s21_map.try_emplace(i, std::to_string(i));
+  const std::string *address = &s21_map.at(200);
+  s21::map<int, std::string> upper = s21_map.split(150);
+  EXPECT_EQ(s21_map.size(), 150U);
+  EXPECT_EQ(upper.size(), 150U);
+  EXPECT_EQ(&upper.at(200), address);
+  EXPECT_FALSE(s21_map.contains(150));
+  EXPECT_EQ(upper.begin()->first, 150);
+  EXPECT_TRUE(s21_map.is_balanced());
+  EXPECT_TRUE(upper.is_balanced());
+
+  s21::map<int, std::string> foreign(
+      s21::pool_allocator<std::pair<int, std::string>>::isolated());
+  foreign.try_emplace(400, "x");
+  foreign.try_emplace(500, "y");
+  upper.join({350, "pivot"}, foreign);
+  EXPECT_TRUE(foreign.empty());
+  EXPECT_EQ(upper.at(350), "pivot");
+  EXPECT_EQ(upper.at(500), "y");
+  s21_map.join(upper);
+  EXPECT_EQ(&s21_map.at(200), address);
+  EXPECT_EQ(s21_map.size(), 303U);
+  EXPECT_TRUE(s21_map.is_balanced());
+  int expected = 0;
+  for (auto it = s21_map.begin(); expected < 300; ++it, ++expected) {
+    EXPECT_EQ(it->first, expected);
+  }
+}
+
+TEST(map_test_eq, btree_backend) {
+  using btree_map =
+      s21::map<int, std::string, s21::pair_compare<int, std::string>,
+               s21::pool_allocator<std::pair<int, std::string>>,
+               s21::btree_options<6>>;
+  btree_map s21_map = {{3, "three"}, {1, "one"}};
+  std::map<int, std::string> std_map = {{3, "three"}, {1, "one"}};
+  std::mt19937 gen(22);
+  for (int i = 0; i < 8000; ++i) {
+    int key = static_cast<int>(gen() % 700);
+    std::string value = std::to_string(i);
+    switch (gen() % 4) {
+      case 0:
+        s21_map[key] = value;
+        std_map[key] = value;
+        break;
+      case 1:
+        EXPECT_EQ(s21_map.try_emplace(key, value).second,
+                  std_map.try_emplace(key, value).second);
+        break;
+      case 2:
+        EXPECT_EQ(s21_map.erase(key), std_map.erase(key));
+        break;
+      default:
+        EXPECT_EQ(s21_map.insert_or_assign({key, value}).second,
+                  std_map.insert_or_assign(key, value).second);
+    }
+  }
+  EXPECT_TRUE(s21_map.is_balanced());
+  EXPECT_EQ(s21_map.size(), std_map.size());
+  EXPECT_TRUE(containers_equal(s21_map.begin(), s21_map.end(),
+                               std_map.begin(), std_map.end()));
+  for (int key : {-1, 0, 350, 699, 700}) {
+    auto lower = s21_map.lower_bound(key);
+    auto std_lower = std_map.lower_bound(key);
+    EXPECT_EQ(lower == s21_map.end(), std_lower == std_map.end());
+    if (std_lower != std_map.end()) {
+      EXPECT_EQ(lower->first, std_lower->first);
+    }
+    EXPECT_EQ(s21_map.contains(key), std_map.count(key) == 1);
+  }
+
+  btree_map upper = s21_map.split(350);
+  EXPECT_TRUE(containers_equal(upper.begin(), upper.end(),
+                               std_map.lower_bound(350), std_map.end()));
+  s21_map.join(upper);
+  auto handle = s21_map.extract(s21_map.begin()->first);
+  handle.key() = 1000;
+  handle.mapped() = "moved";
+  EXPECT_TRUE(s21_map.insert(std::move(handle)).inserted);
+  EXPECT_EQ(s21_map.at(1000), "moved");
+  EXPECT_THROW(s21_map.at(-5), std::out_of_range);
+  EXPECT_TRUE(s21_map.is_balanced());
+}
+
+struct opaque_key_compare {
+  bool operator()(const std::pair<int, std::string>& lhs,
+                  const std::pair<int, std::string>& rhs) const {
+    return lhs.first < rhs.first;
+  }
+};
+
+TEST(map_test_eq, find_many_in_input_order) {
+  s21::map<int, std::string> s21_map;
+  s21::map<int, std::string, opaque_key_compare> s21_opaque;
+  std::map<int, std::string> std_map;
+  for (int i = 0; i < 200; ++i) {
+    s21_map.insert(i * 2, std::to_string(i));
+    s21_opaque.insert(i * 2, std::to_string(i));
+    std_map.insert({i * 2, std::to_string(i)});
+  }
+  std::vector<int> keys = {7, 0, 398, 399, 100, 100, -1, 51, 52};
+
+  std::vector<s21::map<int, std::string>::iterator> found;
+  s21_map.find_many(keys.begin(), keys.end(), std::back_inserter(found));
+  const auto& const_opaque = s21_opaque;
+  std::vector<s21::map<int, std::string, opaque_key_compare>::const_iterator>
+      opaque_found;
+  const_opaque.find_many(keys.begin(), keys.end(),
+                         std::back_inserter(opaque_found));
+  ASSERT_EQ(found.size(), keys.size());
+  ASSERT_EQ(opaque_found.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto expected = std_map.find(keys[i]);
+    if (expected == std_map.end()) {
+      EXPECT_TRUE(found[i] == s21_map.end());
+      EXPECT_TRUE(opaque_found[i] == const_opaque.cend());
+    } else {
+      EXPECT_EQ(found[i]->second, expected->second);
+      EXPECT_EQ(opaque_found[i]->second, expected->second);
+    }
+  }
+}
+
+TEST(map_test_eq, freeze_and_thaw) {
+  s21::map<int, std::string> s21_map;
+  s21::map<int, std::string, opaque_key_compare> s21_opaque;
+  std::map<int, std::string> std_map;
+  for (int i = 0; i < 100; ++i) {
+    s21_map.insert((i * 13) % 200, std::to_string(i));
+    s21_opaque.insert((i * 13) % 200, std::to_string(i));
+    std_map.insert({(i * 13) % 200, std::to_string(i)});
+  }
+  auto frozen = s21_map.freeze();
+  auto frozen_opaque = s21_opaque.freeze();
+  ASSERT_EQ(frozen.size(), std_map.size());
+  auto expected = std_map.begin();
+  for (const auto& item : frozen) {
+    EXPECT_EQ(item.first, expected->first);
+    EXPECT_EQ(item.second, expected->second);
+    ++expected;
+  }
+  for (int key = -1; key <= 200; ++key) {
+    auto lower = std_map.lower_bound(key);
+    EXPECT_EQ(frozen.count(key), std_map.count(key));
+    EXPECT_EQ(frozen_opaque.contains(key), std_map.count(key) != 0);
+    if (lower == std_map.end()) {
+      EXPECT_TRUE(frozen.lower_bound(key) == frozen.end());
+      EXPECT_TRUE(frozen_opaque.lower_bound(key) == frozen_opaque.end());
+    } else {
+      EXPECT_EQ(frozen.lower_bound(key)->first, lower->first);
+      EXPECT_EQ(frozen_opaque.lower_bound(key)->first, lower->first);
+    }
+  }
+  EXPECT_EQ(frozen.at(13), std_map.at(13));
+  EXPECT_EQ(frozen_opaque.upper_bound(13)->first,
+            std_map.upper_bound(13)->first);
+  for (int key : {-1, 13, 14, 187, 199}) {
+    auto range = frozen.equal_range(key);
+    auto opaque_range = frozen_opaque.equal_range(key);
+    auto expected_range = std_map.equal_range(key);
+    EXPECT_EQ(range.first == range.second,
+              expected_range.first == expected_range.second);
+    EXPECT_TRUE(range.first == frozen.lower_bound(key));
+    EXPECT_TRUE(opaque_range.second == frozen_opaque.upper_bound(key));
+    if (expected_range.second == std_map.end()) {
+      EXPECT_TRUE(range.second == frozen.end());
+    } else {
+      EXPECT_EQ(range.second->first, expected_range.second->first);
+    }
+  }
+  EXPECT_THROW(frozen.at(201), std::out_of_range);
+
+  s21::map<int, std::string> thawed = frozen.thaw();
+  thawed[201] = "extra";
+  EXPECT_EQ(thawed.size(), std_map.size() + 1);
+  EXPECT_FALSE(frozen.contains(201));
+}
@@ -2,7 +2,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <iterator>
 #include <set>
+#include <vector>
 
 template <typename iterator1, typename iterator2>
 bool containers_equal(iterator1 begin1, iterator1 end1, iterator2 begin2,
@@ -303,4 +306,292 @@ TEST(multiset_test, contains_method) {
   EXPECT_TRUE(s21_multiset.contains(5));
 
   EXPECT_FALSE(s21_multiset.contains(20));
-}
\ No newline at end of file
+}
+TEST(multiset_test_eq, range_constructor_sorted_duplicates) {
+  std::vector<int> items = {1, 1, 2, 3, 3, 3, 4, 8, 8, 9};
+  s21::multiset<int> s21_multiset(items.begin(), items.end());
+  std::multiset<int> std_multiset(items.begin(), items.end());
+
+  EXPECT_EQ(s21_multiset.size(), std_multiset.size());
+  EXPECT_TRUE(s21_multiset.is_balanced());
+  EXPECT_TRUE(containers_equal(s21_multiset.begin(), s21_multiset.end(),
+                               std_multiset.begin(), std_multiset.end()));
+}
+
+TEST(multiset_test_eq, insert_with_hint) {
+  s21::multiset<int> s21_multiset;
+  std::multiset<int> std_multiset;
+  for (int i = 0; i < 100; ++i) {
+    s21_multiset.insert(s21_multiset.end(), i / 3);
+    std_multiset.insert(std_multiset.end(), i / 3);
+  }
+  s21_multiset.insert(s21_multiset.find(10), 10);
+  std_multiset.insert(std_multiset.find(10), 10);
+  s21_multiset.insert(s21_multiset.begin(), 20);
+  std_multiset.insert(std_multiset.begin(), 20);
+  s21_multiset.emplace_hint(s21_multiset.end(), 0);
+  std_multiset.emplace_hint(std_multiset.end(), 0);
+
+  EXPECT_EQ(s21_multiset.size(), std_multiset.size());
+  EXPECT_TRUE(s21_multiset.is_balanced());
+  EXPECT_TRUE(containers_equal(s21_multiset.begin(), s21_multiset.end(),
+                               std_multiset.begin(), std_multiset.end()));
+}
+
+TEST(multiset_test, emplace_and_move_insert) {
+  s21::multiset<std::string> s21_multiset;
+  s21_multiset.emplace(2, 'b');
+  s21_multiset.emplace("bb");
+  s21_multiset.insert(std::string("a"));
+  s21_multiset.emplace_hint(s21_multiset.begin(), "a");
+
+  std::multiset<std::string> std_multiset{"bb", "bb", "a", "a"};
+  EXPECT_TRUE(containers_equal(s21_multiset.begin(), s21_multiset.end(),
+                               std_multiset.begin(), std_multiset.end()));
+}
+
+TEST(multiset_test, extract_and_insert_node) {
+  s21::multiset<int> source = {1, 2, 2, 3};
+  s21::multiset<int> target;
+  target.insert(2);
+  auto handle = source.extract(2);
+  ASSERT_FALSE(handle.empty());
+  const int *address = &handle.value();
+  auto it = target.insert(std::move(handle));
+  EXPECT_EQ(&*it, address);
+  EXPECT_EQ(source.size(), 3U);
+  EXPECT_EQ(target.size(), 2U);
+  EXPECT_TRUE(source.extract(5).empty());
+  EXPECT_TRUE(target.is_balanced());
+}
+
+TEST(multiset_test_eq, merge_relinks_nodes) {
+  for (int other_size : {4, 200}) {
+    s21::multiset<int> s21_multiset;
+    s21::multiset<int> s21_multiset2;
+    std::multiset<int> std_multiset;
+    for (int i = 0; i < 200; ++i) {
+      s21_multiset.insert(i % 50);
+      std_multiset.insert(i % 50);
+    }
+    for (int i = 0; i < other_size; ++i) {
+      s21_multiset2.insert(i % 70);
+      std_multiset.insert(i % 70);
+    }
+    const int *address = &*s21_multiset2.find(1);
+    s21_multiset.merge(s21_multiset2);
+
+    EXPECT_TRUE(s21_multiset2.empty());
+    EXPECT_EQ(s21_multiset.size(), std_multiset.size());
+    EXPECT_TRUE(containers_equal(s21_multiset.begin(), s21_multiset.end(),
+                                 std_multiset.begin(), std_multiset.end()));
+    EXPECT_TRUE(s21_multiset.is_balanced());
+    bool found = false;
+    for (auto it = s21_multiset.begin(); it != s21_multiset.end(); ++it) {
+      found = found || &*it == address;
+    }
+    EXPECT_TRUE(found);
+  }
+}
+
+TEST(multiset_test, order_statistics) {
+  s21::multiset<int, std::less<int>, s21::pool_allocator<int>,
+                s21::tree_options<true>>
+      s21_multiset = {5, 1, 3, 3, 3, 8, 1};
+  EXPECT_EQ(*s21_multiset.nth(0), 1);
+  EXPECT_EQ(*s21_multiset.nth(4), 3);
+  EXPECT_EQ(*s21_multiset.nth(6), 8);
+  EXPECT_EQ(s21_multiset.rank(3), 2U);
+  EXPECT_EQ(s21_multiset.rank(4), 5U);
+  EXPECT_EQ(s21_multiset.count_range(3, 6), 4U);
+  s21_multiset.insert(s21_multiset.find(3), 3);
+  EXPECT_EQ(s21_multiset.count_range(3, 4), 4U);
+}
+
+TEST(multiset_test_eq, erase_exact_position) {
+  s21::multiset<int> s21_multiset = {1, 2, 2, 2, 3};
+  std::multiset<int> std_multiset = {1, 2, 2, 2, 3};
+  auto second = s21_multiset.lower_bound(2);
+  ++second;
+  const int *kept = &*s21_multiset.lower_bound(2);
+  s21_multiset.erase(second);
+  std_multiset.erase(std::next(std_multiset.lower_bound(2)));
+  EXPECT_EQ(&*s21_multiset.lower_bound(2), kept);
+  EXPECT_TRUE(containers_equal(s21_multiset.begin(), s21_multiset.end(),
+                               std_multiset.begin(), std_multiset.end()));
+  EXPECT_TRUE(s21_multiset.is_balanced());
+}
+
+TEST(multiset_test_eq, erase_key_and_erase_if) {
+  s21::multiset<int> s21_multiset;
+  std::multiset<int> std_multiset;
+  for (int i = 0; i < 300; ++i) {
+    s21_multiset.insert(i % 7);
+    std_multiset.insert(i % 7);
+  }
+  EXPECT_EQ(s21_multiset.erase(3), std_multiset.erase(3));
+  EXPECT_EQ(s21_multiset.erase(3), 0U);
+  auto pred = [](int value) { return value > 4; };
+  size_t expected = 0;
+  for (auto it = std_multiset.begin(); it != std_multiset.end();) {
+    it = pred(*it) ? (++expected, std_multiset.erase(it)) : std::next(it);
+  }
+  EXPECT_EQ(s21::erase_if(s21_multiset, pred), expected);
+  EXPECT_TRUE(s21_multiset.is_balanced());
+  EXPECT_TRUE(containers_equal(s21_multiset.begin(), s21_multiset.end(),
+                               std_multiset.begin(), std_multiset.end()));
+}
+
+TEST(multiset_test_eq, split_and_join) {
+  s21::multiset<int> s21_multiset;
+  std::multiset<int> std_multiset;
+  for (int i = 0; i < 600; ++i) {
+    s21_multiset.insert(i % 40);
+    std_multiset.insert(i % 40);
+  }
+  s21::multiset<int> upper = s21_multiset.split(20);
+  auto middle = std_multiset.lower_bound(20);
+  EXPECT_TRUE(containers_equal(s21_multiset.begin(), s21_multiset.end(),
+                               std_multiset.begin(), middle));
+  EXPECT_TRUE(containers_equal(upper.begin(), upper.end(), middle,
+                               std_multiset.end()));
+  EXPECT_TRUE(s21_multiset.is_balanced());
+  EXPECT_TRUE(upper.is_balanced());
+
+  s21::multiset<int> empty;
+  s21_multiset.join(19, empty);
+  s21_multiset.join(20, upper);
+  std_multiset.insert({19, 20});
+  EXPECT_EQ(s21_multiset.size(), std_multiset.size());
+  EXPECT_TRUE(s21_multiset.is_balanced());
+  EXPECT_TRUE(containers_equal(s21_multiset.begin(), s21_multiset.end(),
+                               std_multiset.begin(), std_multiset.end()));
+}
+
+TEST(multiset_test_eq, set_algebra) {
+  std::multiset<int> std_lhs;
+  std::multiset<int> std_rhs;
+  for (int i = 0; i < 400; ++i) std_lhs.insert(i % 50);
+  for (int i = 0; i < 30; ++i) std_rhs.insert(i % 60 + 25);
+  s21::multiset<int> s21_lhs(std_lhs.begin(), std_lhs.end());
+  s21::multiset<int> s21_rhs(std_rhs.begin(), std_rhs.end());
+
+  std::vector<int> expected;
+  std::set_union(std_lhs.begin(), std_lhs.end(), std_rhs.begin(),
+                 std_rhs.end(), std::back_inserter(expected));
+  s21::multiset<int> result = s21::set_union(s21_lhs, s21_rhs);
+  EXPECT_TRUE(result.is_balanced());
+  EXPECT_TRUE(containers_equal(result.begin(), result.end(),
+                               expected.begin(), expected.end()));
+
+  expected.clear();
+  std::set_intersection(std_lhs.begin(), std_lhs.end(), std_rhs.begin(),
+                        std_rhs.end(), std::back_inserter(expected));
+  result = s21::set_intersection(s21_lhs, s21_rhs);
+  EXPECT_TRUE(containers_equal(result.begin(), result.end(),
+                               expected.begin(), expected.end()));
+
+  expected.clear();
+  std::set_difference(std_rhs.begin(), std_rhs.end(), std_lhs.begin(),
+                      std_lhs.end(), std::back_inserter(expected));
+  result = s21::set_difference(s21_rhs, s21_lhs);
+  EXPECT_TRUE(containers_equal(result.begin(), result.end(),
+                               expected.begin(), expected.end()));
+
+  expected.clear();
+  std::set_symmetric_difference(std_lhs.begin(), std_lhs.end(),
+                                std_rhs.begin(), std_rhs.end(),
+                                std::back_inserter(expected));
+  result = s21::set_symmetric_difference(s21_lhs, s21_rhs);
+  EXPECT_EQ(result.size(), expected.size());
+  EXPECT_TRUE(result.is_balanced());
+  EXPECT_TRUE(containers_equal(result.begin(), result.end(),
+                               expected.begin(), expected.end()));
+}
+
+TEST(multiset_test_eq, parallel_insert_sorted) {
+  s21::multiset<int> s21_multiset;
+  std::multiset<int> std_multiset;
+  for (int i = 0; i < 30000; ++i) {
+    s21_multiset.insert(i % 1000);
+    std_multiset.insert(i % 1000);
+  }
+  std::vector<int> batch;
+  for (int i = 0; i < 40000; ++i) batch.push_back(i / 20);
+  s21_multiset.insert_sorted(batch.begin(), batch.end(),
+                             s21::execution::parallel);
+  std_multiset.insert(batch.begin(), batch.end());
+  EXPECT_TRUE(s21_multiset.is_balanced());
+  EXPECT_EQ(s21_multiset.size(), std_multiset.size());
+  EXPECT_TRUE(containers_equal(s21_multiset.begin(), s21_multiset.end(),
+                               std_multiset.begin(), std_multiset.end()));
+
+  s21::multiset<int> result = s21::set_intersection(
+      s21_multiset, s21::multiset<int>(batch.begin(), batch.end()),
+      s21::execution::parallel);
+  EXPECT_EQ(result.size(), batch.size());
+  EXPECT_TRUE(result.is_balanced());
+}
+
+TEST(multiset_test_eq, btree_backend) {
+  using btree_multiset = s21::multiset<int, std::less<int>,
+                                       s21::pool_allocator<int>,
+                                       s21::btree_options<5>>;
+  btree_multiset s21_multiset = {5, 1, 5, 3, 1};
+  std::multiset<int> std_multiset = {5, 1, 5, 3, 1};
+  for (int i = 0; i < 5000; ++i) {
+    int value = (i * 37) % 101;
+    if (i % 3 == 2) {
+      EXPECT_EQ(s21_multiset.erase(value), std_multiset.erase(value));
+    } else if (i % 3 == 1) {
+      s21_multiset.insert(s21_multiset.upper_bound(value), value);
+      std_multiset.insert(value);
+    } else {
+      s21_multiset.insert(value);
+      std_multiset.insert(value);
+    }
+  }
+  EXPECT_TRUE(s21_multiset.is_balanced());
+  EXPECT_EQ(s21_multiset.size(), std_multiset.size());
+  EXPECT_TRUE(containers_equal(s21_multiset.begin(), s21_multiset.end(),
+                               std_multiset.begin(), std_multiset.end()));
+
+  btree_multiset upper = s21_multiset.split(50);
+  EXPECT_TRUE(containers_equal(upper.begin(), upper.end(),
+                               std_multiset.lower_bound(50),
+                               std_multiset.end()));
+  s21_multiset.join(50, upper);
+  std_multiset.insert(50);
+  btree_multiset other = {50, 50, 200};
+  s21_multiset.merge(other);
+  std_multiset.insert({50, 50, 200});
+  EXPECT_TRUE(other.empty());
+  EXPECT_TRUE(s21_multiset.extract(200));
+  std_multiset.erase(200);
+  EXPECT_TRUE(s21_multiset.is_balanced());
+  EXPECT_TRUE(containers_equal(s21_multiset.begin(), s21_multiset.end(),
+                               std_multiset.begin(), std_multiset.end()));
+
+  btree_multiset twice = s21::set_union(s21_multiset, s21_multiset);
+  EXPECT_EQ(twice.size(), s21_multiset.size());
+  btree_multiset none = s21::set_difference(s21_multiset, twice);
+  EXPECT_TRUE(none.empty());
+}
+
+TEST(multiset_test_eq, prefetch_option) {
+  s21::multiset<int, std::less<int>, s21::pool_allocator<int>,
+                s21::tree_options<false, true>>
+      s21_multiset;
+  std::multiset<int> std_multiset;
+  for (int i = 0; i < 500; ++i) {
+    s21_multiset.insert(i * 7 % 101);
+    std_multiset.insert(i * 7 % 101);
+  }
+  EXPECT_TRUE(containers_equal(s21_multiset.begin(), s21_multiset.end(),
+                               std_multiset.begin(), std_multiset.end()));
+  for (int key = -1; key <= 101; ++key) {
+    EXPECT_TRUE(containers_equal(
+        s21_multiset.lower_bound(key), s21_multiset.upper_bound(key),
+        std_multiset.lower_bound(key), std_multiset.upper_bound(key)));
+  }
+}
@@ -0,0 +1,103 @@
+#include "../s21_lib/s21_persistent_map.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+template <typename persistent, typename ordered>
+bool same_items(const persistent &lhs, const ordered &rhs) {
+  if (lhs.size() != rhs.size()) return false;
+  auto expected = rhs.begin();
+  for (const auto &item : lhs) {
+    if (item.first != expected->first || item.second != expected->second) {
+      return false;
+    }
+    ++expected;
+  }
+  return true;
+}
+
+TEST(persistent_map_test_eq, versions_are_independent) {
+  s21::persistent_map<int, std::string> empty;
+  auto first = empty.insert(1, "one").insert(2, "two");
+  auto second = first.insert_or_assign(1, "uno").erase(2).insert(3, "tres");
+
+  EXPECT_TRUE(empty.empty());
+  EXPECT_TRUE(same_items(first, std::map<int, std::string>{{1, "one"},
+                                                           {2, "two"}}));
+  EXPECT_TRUE(same_items(second, std::map<int, std::string>{{1, "uno"},
+                                                            {3, "tres"}}));
+  EXPECT_EQ(first.version(), 2u);
+  EXPECT_EQ(second.version(), 5u);
+  EXPECT_EQ(first.at(1), "one");
+  EXPECT_THROW(second.at(2), std::out_of_range);
+  EXPECT_TRUE(second.contains(3));
+  EXPECT_EQ(second.count(2), 0u);
+  EXPECT_EQ(second.lower_bound(2)->first, 3);
+
+  EXPECT_TRUE(first.insert(1, "ignored").same_version(first));
+  EXPECT_TRUE(first.erase(7).same_version(first));
+  auto snapshot = second;
+  EXPECT_TRUE(snapshot.same_version(second));
+}
+
+TEST(persistent_map_test_eq, random_history_matches_std) {
+  std::mt19937 generator(22);
+  std::uniform_int_distribution<int> key(0, 150);
+  std::vector<s21::persistent_map<int, int>> versions(1);
+  std::vector<std::map<int, int>> expected(1);
+  for (int step = 0; step < 1500; ++step) {
+    int value = key(generator);
+    std::map<int, int> next = expected.back();
+    if (step % 3 == 0) {
+      next.erase(value);
+      versions.push_back(versions.back().erase(value));
+    } else {
+      next[value] = step;
+      versions.push_back(versions.back().insert_or_assign(value, step));
+    }
+    expected.push_back(next);
+    ASSERT_TRUE(versions.back().is_balanced());
+  }
+  for (size_t i = 0; i < versions.size(); i += 50) {
+    EXPECT_TRUE(same_items(versions[i], expected[i]));
+  }
+  EXPECT_TRUE(same_items(versions.back(), expected.back()));
+}
+
+TEST(persistent_map_test, readers_see_whole_versions) {
+  s21::versioned<s21::persistent_map<int, int>> published;
+  std::atomic<bool> done(false);
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 3; ++t) {
+    readers.emplace_back([&published, &done] {
+      while (!done) {
+        s21::persistent_map<int, int> snapshot = published.snapshot();
+        // писатель добавляет ключи 0..v-1 со значением v
+        int size = static_cast<int>(snapshot.size());
+        for (const auto &item : snapshot) {
+          EXPECT_EQ(item.second, size);
+        }
+      }
+    });
+  }
+  for (int v = 1; v <= 200; ++v) {
+    published.update([v](const s21::persistent_map<int, int> &current) {
+      s21::persistent_map<int, int> next = current;
+      for (int i = 0; i < v; ++i) {
+        next = next.insert_or_assign(i, v);
+      }
+      return next;
+    });
+  }
+  done = true;
+  for (std::thread &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(published.snapshot().size(), 200u);
+}
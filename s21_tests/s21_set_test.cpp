@@ -2,7 +2,15 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <random>
 #include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 template <typename iterator1, typename iterator2>
 bool containers_equal(iterator1 begin1, iterator1 end1, iterator2 begin2,
@@ -301,4 +309,1150 @@ TEST(set_test, single_element_insert) {
   EXPECT_EQ(s21_set.size(), 1U);
 
   EXPECT_TRUE(results[0].second);
-}
\ No newline at end of file
+}
+TEST(set_test, pool_allocator_reuses_nodes) {
+  s21::set<int> s21_set;
+  s21_set.insert(1);
+  const int *first_node = &*s21_set.begin();
+  s21_set.erase(s21_set.begin());
+  s21_set.insert(2);
+
+  EXPECT_EQ(&*s21_set.begin(), first_node);
+}
+
+TEST(set_test, pool_shared_across_threads) {
+  s21::set<int> lhs;
+  s21::set<int> rhs = {1, 2, 3};
+  s21::set<int> isolated(s21::pool_allocator<int>::isolated());
+  EXPECT_TRUE(lhs.get_allocator() == rhs.get_allocator());
+  EXPECT_FALSE(lhs.get_allocator() == isolated.get_allocator());
+
+  // пул общий, а контейнеры живут в разных потоках
+  std::thread worker([moved = std::move(rhs)]() mutable {
+    for (int i = 0; i < 20000; ++i) {
+      moved.insert(i);
+      moved.erase(moved.find(i / 2));
+    }
+  });
+  for (int i = 0; i < 20000; ++i) {
+    lhs.insert(i);
+    lhs.erase(lhs.find(i / 2));
+  }
+  worker.join();
+  EXPECT_EQ(lhs.size(), 10000U);
+  EXPECT_TRUE(lhs.is_balanced());
+}
+
+TEST(set_test, pool_rebind_keeps_source_pool) {
+  s21::set<int> s21_set = {1, 2, 3};
+  s21::pool_allocator<int> alloc = s21_set.get_allocator();
+  bool same_pool = false;
+  bool thread_pool_differs = false;
+  // узлы другого потока строятся на пулах потока-источника аллокатора
+  std::thread([&] {
+    s21::set<int> target(alloc);
+    target.insert(4);
+    same_pool = target.get_allocator() == s21_set.get_allocator();
+    thread_pool_differs =
+        s21::set<int>().get_allocator() != s21_set.get_allocator();
+    s21_set.merge(target);
+  }).join();
+  EXPECT_TRUE(same_pool);
+  EXPECT_TRUE(thread_pool_differs);
+  EXPECT_EQ(s21_set.size(), 4U);
+}
+
+TEST(set_test, std_allocator_policy) {
+  s21::set<int, std::less<int>, std::allocator<int>> s21_set({5, 1, 3, 2, 4});
+  std::set<int> std_set({5, 1, 3, 2, 4});
+  s21::set<int, std::less<int>, std::allocator<int>> s21_set_copy(s21_set);
+  s21_set.clear();
+
+  EXPECT_TRUE(containers_equal(s21_set_copy.begin(), s21_set_copy.end(),
+                               std_set.begin(), std_set.end()));
+}
+
+TEST(set_test_eq, range_constructor_sorted) {
+  std::vector<int> items;
+  for (int i = 0; i < 1000; ++i) items.push_back(i * 2);
+  s21::set<int> s21_set(items.begin(), items.end());
+  std::set<int> std_set(items.begin(), items.end());
+
+  EXPECT_EQ(s21_set.size(), std_set.size());
+  EXPECT_TRUE(s21_set.is_balanced());
+  EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(), std_set.begin(),
+                               std_set.end()));
+  s21_set.insert(7);
+  s21_set.erase(s21_set.find(500));
+  EXPECT_TRUE(s21_set.is_balanced());
+}
+
+TEST(set_test_eq, range_constructor_unsorted) {
+  std::vector<int> items = {5, 3, 9, 3, 1, 7, 5};
+  s21::set<int> s21_set(items.begin(), items.end());
+  std::set<int> std_set(items.begin(), items.end());
+
+  EXPECT_TRUE(s21_set.is_balanced());
+  EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(), std_set.begin(),
+                               std_set.end()));
+}
+
+TEST(set_test, assign_sorted) {
+  s21::set<int> s21_set({100, 200});
+  for (int n = 0; n < 70; ++n) {
+    std::vector<int> items(n);
+    for (int i = 0; i < n; ++i) items[i] = i;
+    s21_set.assign_sorted(items.begin(), items.end());
+
+    EXPECT_EQ(s21_set.size(), static_cast<size_t>(n));
+    EXPECT_TRUE(s21_set.is_balanced());
+    EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(), items.begin(),
+                                 items.end()));
+  }
+}
+
+// Считает живые объекты; копия бросает, когда кончается бюджет
+struct counted_copy {
+  static int budget;
+  static int live;
+  int value;
+  explicit counted_copy(int v) : value(v) { ++live; }
+  counted_copy(const counted_copy &other) : value(other.value) {
+    if (budget-- == 0) throw std::runtime_error("copy");
+    ++live;
+  }
+  ~counted_copy() { --live; }
+  bool operator<(const counted_copy &other) const {
+    return value < other.value;
+  }
+};
+int counted_copy::budget = -1;
+int counted_copy::live = 0;
+
+TEST(set_test, assign_sorted_throwing_copy) {
+  std::vector<counted_copy> items;
+  for (int i = 0; i < 100; ++i) items.emplace_back(i);
+  for (int fail_at : {0, 1, 37, 64, 99}) {
+    s21::set<counted_copy> s21_set;
+    counted_copy::budget = fail_at;
+    EXPECT_THROW(s21_set.assign_sorted(items.begin(), items.end()),
+                 std::runtime_error);
+    counted_copy::budget = -1;
+    EXPECT_TRUE(s21_set.empty());
+    EXPECT_EQ(counted_copy::live, 100);
+  }
+  items.clear();
+  EXPECT_EQ(counted_copy::live, 0);
+}
+
+TEST(set_test_eq, insert_with_hint) {
+  s21::set<int> s21_set;
+  std::set<int> std_set;
+  for (int i = 0; i < 200; ++i) {
+    s21_set.insert(s21_set.end(), i);
+    std_set.insert(std_set.end(), i);
+  }
+  auto it = s21_set.insert(s21_set.find(50), 50);
+  EXPECT_EQ(*it, 50);
+  it = s21_set.insert(s21_set.begin(), -1);
+  EXPECT_EQ(*it, -1);
+  std_set.insert(-1);
+  it = s21_set.insert(s21_set.begin(), 1000);
+  EXPECT_EQ(*it, 1000);
+  std_set.insert(1000);
+  it = s21_set.emplace_hint(s21_set.find(100), 99);
+  EXPECT_EQ(*it, 99);
+
+  EXPECT_EQ(s21_set.size(), std_set.size());
+  EXPECT_TRUE(s21_set.is_balanced());
+  EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(), std_set.begin(),
+                               std_set.end()));
+}
+
+TEST(set_test, balanced_after_double_rotation) {
+  s21::set<int> s21_set({11, 94, 37, 8, 46, 99, 59});
+  s21_set.insert(58);
+
+  EXPECT_TRUE(s21_set.is_balanced());
+}
+
+TEST(set_test, emplace_and_move_insert) {
+  s21::set<std::string> s21_set;
+  std::string long_value(100, 'x');
+  const char *buffer = long_value.data();
+
+  auto result = s21_set.insert(std::move(long_value));
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(result.first->data(), buffer);
+
+  EXPECT_TRUE(s21_set.emplace(3, 'a').second);
+  EXPECT_FALSE(s21_set.emplace("aaa").second);
+  EXPECT_EQ(*s21_set.emplace_hint(s21_set.end(), 2, 'z'), "zz");
+
+  std::string duplicate = "zz";
+  EXPECT_FALSE(s21_set.insert(std::move(duplicate)).second);
+  EXPECT_EQ(duplicate, "zz");
+  EXPECT_EQ(s21_set.size(), 3U);
+}
+
+TEST(set_test_eq, erase_random) {
+  s21::set<int> s21_set;
+  std::set<int> std_set;
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> dist(0, 499);
+  for (int i = 0; i < 5000; ++i) {
+    int value = dist(gen);
+    if (i % 3 == 0) {
+      auto it = s21_set.find(value);
+      if (it != s21_set.end()) s21_set.erase(it);
+      std_set.erase(value);
+    } else {
+      s21_set.insert(value);
+      std_set.insert(value);
+    }
+  }
+  EXPECT_TRUE(s21_set.is_balanced());
+  EXPECT_EQ(s21_set.size(), std_set.size());
+  EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(), std_set.begin(),
+                               std_set.end()));
+}
+
+TEST(set_test, erase_keeps_iterators) {
+  s21::set<int> s21_set = {5, 2, 8, 1, 3, 7, 9};
+  auto it = s21_set.find(8);
+  const int *address = &*it;
+  s21_set.erase(s21_set.find(5));
+  EXPECT_EQ(&*s21_set.find(8), address);
+  EXPECT_EQ(*it, 8);
+  EXPECT_TRUE(s21_set.is_balanced());
+}
+
+TEST(set_test, extract_and_insert_node) {
+  s21::set<std::string> source = {"a", "b", "c"};
+  s21::set<std::string> target;
+  auto handle = source.extract("b");
+  const std::string *address = &handle.value();
+  auto result = target.insert(std::move(handle));
+  EXPECT_TRUE(result.inserted);
+  EXPECT_EQ(&*result.position, address);
+  EXPECT_FALSE(source.contains("b"));
+
+  auto again = target.insert(target.extract(target.begin()));
+  EXPECT_TRUE(again.inserted);
+  EXPECT_EQ(*again.position, "b");
+  EXPECT_FALSE(target.insert(s21::set<std::string>::node_type()).inserted);
+}
+
+TEST(set_test_eq, merge_leaves_duplicates) {
+  std::mt19937 gen(7);
+  std::uniform_int_distribution<int> dist(0, 999);
+  for (int other_size : {5, 300}) {
+    s21::set<int> s21_set;
+    s21::set<int> s21_other;
+    s21::set<int> s21_copy;
+    s21::set<int> s21_foreign(s21::pool_allocator<int>::isolated());
+    std::set<int> std_set;
+    std::set<int> std_other;
+    for (int i = 0; i < 300; ++i) {
+      int value = dist(gen);
+      s21_set.insert(value);
+      s21_copy.insert(value);
+      std_set.insert(value);
+    }
+    for (int i = 0; i < other_size; ++i) {
+      int value = dist(gen);
+      s21_other.insert(value);
+      s21_foreign.insert(value);
+      std_other.insert(value);
+    }
+    std::set<const int *> other_nodes;
+    for (const int &value : s21_other) other_nodes.insert(&value);
+    size_t size_before = s21_set.size();
+    s21_copy.merge(s21_foreign);
+    s21_set.merge(s21_other);
+    std_set.merge(std_other);
+    // перенесенные элементы - те же узлы, без копий
+    size_t relinked = 0;
+    for (const int &value : s21_set) relinked += other_nodes.count(&value);
+    EXPECT_EQ(relinked, s21_set.size() - size_before);
+
+    EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(),
+                                 std_set.begin(), std_set.end()));
+    EXPECT_TRUE(containers_equal(s21_other.begin(), s21_other.end(),
+                                 std_other.begin(), std_other.end()));
+    EXPECT_TRUE(containers_equal(s21_copy.begin(), s21_copy.end(),
+                                 std_set.begin(), std_set.end()));
+    EXPECT_TRUE(containers_equal(s21_foreign.begin(), s21_foreign.end(),
+                                 std_other.begin(), std_other.end()));
+    EXPECT_EQ(s21_set.size(), std_set.size());
+    EXPECT_EQ(s21_other.size(), std_other.size());
+    EXPECT_TRUE(s21_set.is_balanced());
+    EXPECT_TRUE(s21_other.is_balanced());
+    EXPECT_TRUE(s21_copy.is_balanced());
+  }
+}
+
+TEST(set_test, order_statistics) {
+  using ranked_set =
+      s21::set<int, std::less<int>, s21::pool_allocator<int>,
+               s21::tree_options<true>>;
+  ranked_set s21_set;
+  std::set<int> std_set;
+  std::mt19937 gen(3);
+  std::uniform_int_distribution<int> dist(0, 1999);
+  for (int i = 0; i < 3000; ++i) {
+    int value = dist(gen);
+    if (i % 4 == 0) {
+      auto it = s21_set.find(value);
+      if (it != s21_set.end()) s21_set.erase(it);
+      std_set.erase(value);
+    } else {
+      s21_set.insert(value);
+      std_set.insert(value);
+    }
+  }
+  ASSERT_EQ(s21_set.size(), std_set.size());
+  size_t index = 0;
+  for (int value : std_set) {
+    EXPECT_EQ(*s21_set.nth(index), value);
+    EXPECT_EQ(s21_set.rank(value), index);
+    ++index;
+  }
+  EXPECT_TRUE(s21_set.nth(std_set.size()) == s21_set.end());
+  EXPECT_EQ(s21_set.count_range(500, 1500),
+            static_cast<size_t>(std::distance(std_set.lower_bound(500),
+                                              std_set.lower_bound(1500))));
+  EXPECT_EQ(s21_set.count_range(1500, 500), 0U);
+
+  ranked_set copy(s21_set);
+  EXPECT_EQ(*copy.nth(10), *s21_set.nth(10));
+  ranked_set sorted(std_set.begin(), std_set.end());
+  EXPECT_EQ(sorted.rank(*std_set.rbegin()), std_set.size() - 1);
+}
+
+TEST(set_test_eq, bounds_and_equal_range) {
+  s21::set<int> s21_set = {10, 20, 30, 40, 50};
+  std::set<int> std_set = {10, 20, 30, 40, 50};
+  const s21::set<int> &const_set = s21_set;
+  for (int key : {5, 10, 25, 50, 55}) {
+    auto lower = std_set.lower_bound(key);
+    auto upper = std_set.upper_bound(key);
+    if (lower == std_set.end()) {
+      EXPECT_TRUE(s21_set.lower_bound(key) == s21_set.end());
+    } else {
+      EXPECT_EQ(*s21_set.lower_bound(key), *lower);
+      EXPECT_EQ(*const_set.lower_bound(key), *lower);
+    }
+    if (upper == std_set.end()) {
+      EXPECT_TRUE(s21_set.upper_bound(key) == s21_set.end());
+    } else {
+      EXPECT_EQ(*s21_set.upper_bound(key), *upper);
+      EXPECT_EQ(*const_set.upper_bound(key), *upper);
+    }
+  }
+  auto range = s21_set.equal_range(30);
+  EXPECT_EQ(*range.first, 30);
+  EXPECT_EQ(*range.second, 40);
+  auto empty_range = const_set.equal_range(35);
+  EXPECT_TRUE(empty_range.first == empty_range.second);
+
+  int sum = 0;
+  for (auto it = s21_set.lower_bound(15); it != s21_set.upper_bound(40); ++it) {
+    sum += *it;
+  }
+  EXPECT_EQ(sum, 90);
+}
+
+TEST(set_test_eq, reverse_iteration_from_end) {
+  s21::set<int> s21_set;
+  std::set<int> std_set;
+  std::mt19937 gen(11);
+  std::uniform_int_distribution<int> dist(0, 299);
+  for (int i = 0; i < 1000; ++i) {
+    int value = dist(gen);
+    if (i % 3 == 0) {
+      auto it = s21_set.find(value);
+      if (it != s21_set.end()) s21_set.erase(it);
+      std_set.erase(value);
+    } else {
+      s21_set.insert(value);
+      std_set.insert(value);
+    }
+    ASSERT_EQ(s21_set.empty(), std_set.empty());
+    if (!std_set.empty()) {
+      ASSERT_EQ(s21_set.front(), *std_set.begin());
+      ASSERT_EQ(s21_set.back(), *std_set.rbegin());
+    }
+  }
+  auto std_it = std_set.rbegin();
+  for (auto it = s21_set.end(); it != s21_set.begin(); ++std_it) {
+    --it;
+    EXPECT_EQ(*it, *std_it);
+  }
+  EXPECT_TRUE(std_it == std_set.rend());
+
+  s21::set<int> other = {1000, 1001};
+  s21_set.swap(other);
+  EXPECT_EQ(s21_set.back(), 1001);
+  EXPECT_EQ(*--s21_set.end(), 1001);
+  s21::set<int> moved(std::move(other));
+  EXPECT_EQ(moved.front(), *std_set.begin());
+  EXPECT_TRUE(other.begin() == other.end());
+}
+
+TEST(set_test_eq, erase_range_and_key) {
+  for (int width : {3, 400}) {
+    s21::set<int, std::less<int>, s21::pool_allocator<int>,
+             s21::tree_options<true>>
+        s21_set;
+    std::set<int> std_set;
+    for (int i = 0; i < 1000; ++i) {
+      s21_set.insert(i);
+      std_set.insert(i);
+    }
+    auto last = s21_set.erase(s21_set.lower_bound(300),
+                              s21_set.lower_bound(300 + width));
+    std_set.erase(std_set.lower_bound(300), std_set.lower_bound(300 + width));
+    EXPECT_EQ(*last, 300 + width);
+    EXPECT_EQ(s21_set.size(), std_set.size());
+    EXPECT_TRUE(s21_set.is_balanced());
+    EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(),
+                                 std_set.begin(), std_set.end()));
+    EXPECT_EQ(s21_set.rank(300 + width), 300U);
+    EXPECT_EQ(s21_set.back(), 999);
+
+    EXPECT_EQ(s21_set.erase(999), 1U);
+    EXPECT_EQ(s21_set.erase(999), 0U);
+    EXPECT_EQ(s21_set.back(), 998);
+  }
+  s21::set<int> s21_set = {1, 2, 3};
+  EXPECT_TRUE(s21_set.erase(s21_set.begin(), s21_set.end()) == s21_set.end());
+  EXPECT_TRUE(s21_set.empty());
+  EXPECT_TRUE(s21_set.begin() == s21_set.end());
+}
+
+TEST(set_test_eq, erase_if) {
+  for (int modulo : {2, 50}) {
+    s21::set<int> s21_set;
+    std::set<int> std_set;
+    for (int i = 0; i < 500; ++i) {
+      s21_set.insert(i);
+      std_set.insert(i);
+    }
+    auto pred = [modulo](int value) { return value % modulo == 1; };
+    size_t expected = 0;
+    for (auto it = std_set.begin(); it != std_set.end();) {
+      it = pred(*it) ? (++expected, std_set.erase(it)) : std::next(it);
+    }
+    EXPECT_EQ(s21::erase_if(s21_set, pred), expected);
+    EXPECT_TRUE(s21_set.is_balanced());
+    EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(),
+                                 std_set.begin(), std_set.end()));
+  }
+}
+
+TEST(set_test_eq, split_and_join) {
+  std::mt19937 gen(15);
+  std::uniform_int_distribution<int> dist(0, 4999);
+  std::set<int> std_set;
+  for (int i = 0; i < 2000; ++i) std_set.insert(dist(gen));
+  s21::set<int> s21_set(std_set.begin(), std_set.end());
+  for (int key : {-1, 0, 17, 2500, 4999, 6000}) {
+    s21::set<int> upper = s21_set.split(key);
+    auto middle = std_set.lower_bound(key);
+    EXPECT_TRUE(s21_set.is_balanced());
+    EXPECT_TRUE(upper.is_balanced());
+    EXPECT_EQ(s21_set.size(),
+              static_cast<size_t>(std::distance(std_set.begin(), middle)));
+    EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(),
+                                 std_set.begin(), middle));
+    EXPECT_TRUE(containers_equal(upper.begin(), upper.end(), middle,
+                                 std_set.end()));
+    s21_set.join(upper);
+    EXPECT_TRUE(upper.empty());
+    EXPECT_TRUE(s21_set.is_balanced());
+    EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(),
+                                 std_set.begin(), std_set.end()));
+  }
+
+  s21::set<int> right = s21_set.split(2500);
+  s21::set<int> small = {7000};
+  s21::set<int> built;
+  for (int i = 0; i < 500; ++i) built.insert(8000 + i);
+  const int *address = &*built.find(8250);
+  EXPECT_THROW(s21_set.join(2400, right), std::invalid_argument);
+  s21_set.join(right);
+  s21_set.join(6000, small);
+  // независимо построенное дерево подвешивается целиком
+  s21_set.join(built);
+  EXPECT_EQ(&*s21_set.find(8250), address);
+  std_set.insert({6000, 7000});
+  for (int i = 0; i < 500; ++i) std_set.insert(8000 + i);
+  EXPECT_TRUE(s21_set.is_balanced());
+  EXPECT_EQ(s21_set.size(), std_set.size());
+  EXPECT_EQ(s21_set.back(), 8499);
+  EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(),
+                               std_set.begin(), std_set.end()));
+}
+
+TEST(set_test, split_on_another_thread) {
+  s21::set<int> s21_set;
+  for (int i = 0; i < 1000; ++i) s21_set.insert(i);
+  s21::set<int> right;
+  std::thread([&] {
+    right = s21_set.split(500);
+    for (int i = 0; i < 100; ++i) right.insert(2000 + i);
+  }).join();
+  EXPECT_TRUE(right.get_allocator() == s21_set.get_allocator());
+  EXPECT_EQ(s21_set.size(), 500U);
+  EXPECT_EQ(right.size(), 600U);
+  EXPECT_EQ(right.front(), 500);
+  s21_set.join(right);
+  EXPECT_TRUE(s21_set.is_balanced());
+  EXPECT_EQ(s21_set.size(), 1100U);
+}
+
+// Каждая копия через rebind получает новую метку, поэтому аллокатор,
+// полученный из get_allocator(), не равен исходному
+template <typename T>
+struct tagged_allocator {
+  using value_type = T;
+  int tag = 0;
+  tagged_allocator() = default;
+  template <typename U>
+  tagged_allocator(const tagged_allocator<U> &other) : tag(other.tag + 1) {}
+  T *allocate(size_t n) { return std::allocator<T>().allocate(n); }
+  void deallocate(T *ptr, size_t n) { std::allocator<T>().deallocate(ptr, n); }
+  template <typename U>
+  bool operator==(const tagged_allocator<U> &other) const {
+    return tag == other.tag;
+  }
+  template <typename U>
+  bool operator!=(const tagged_allocator<U> &other) const {
+    return tag != other.tag;
+  }
+};
+
+TEST(set_test, split_into_foreign_allocator) {
+  s21::set<int, std::less<int>, tagged_allocator<int>> s21_set;
+  for (int i = 0; i < 300; ++i) s21_set.insert(i);
+  auto right = s21_set.split(100);
+  EXPECT_EQ(s21_set.size(), 100U);
+  EXPECT_EQ(right.size(), 200U);
+  EXPECT_TRUE(right.is_balanced());
+  int expected = 100;
+  for (int value : right) EXPECT_EQ(value, expected++);
+}
+
+TEST(set_test, split_and_join_order_statistics) {
+  using ranked_set =
+      s21::set<int, std::less<int>, s21::pool_allocator<int>,
+               s21::tree_options<true>>;
+  ranked_set s21_set;
+  for (int i = 0; i < 1000; ++i) s21_set.insert(i * 2);
+  ranked_set upper = s21_set.split(701);
+  EXPECT_EQ(s21_set.size(), 351U);
+  EXPECT_EQ(upper.size(), 649U);
+  EXPECT_EQ(*s21_set.nth(350), 700);
+  EXPECT_EQ(*upper.nth(0), 702);
+  EXPECT_EQ(upper.rank(1000), 149U);
+  ranked_set tail = upper.split(1500);
+  EXPECT_EQ(tail.size(), 250U);
+  s21_set.join(upper);
+  EXPECT_TRUE(upper.empty());
+  EXPECT_TRUE(s21_set.is_balanced());
+  EXPECT_EQ(s21_set.size(), 750U);
+  EXPECT_EQ(*s21_set.nth(351), 702);
+  EXPECT_EQ(s21_set.rank(1500), 750U);
+  s21_set.join(1499, tail);
+  EXPECT_TRUE(s21_set.is_balanced());
+  EXPECT_EQ(*s21_set.nth(750), 1499);
+  EXPECT_EQ(*s21_set.nth(751), 1500);
+  EXPECT_EQ(s21_set.count_range(0, 2000), 1001U);
+}
+
+TEST(set_test_eq, set_algebra) {
+  std::mt19937 gen(16);
+  for (int small_size : {0, 5, 300, 1000}) {
+    std::uniform_int_distribution<int> dist(0, 2999);
+    s21::set<int> s21_lhs;
+    s21::set<int> s21_rhs;
+    std::set<int> std_lhs;
+    std::set<int> std_rhs;
+    for (int i = 0; i < small_size; ++i) {
+      int value = dist(gen);
+      s21_lhs.insert(value);
+      std_lhs.insert(value);
+    }
+    for (int i = 0; i < 1000; ++i) {
+      int value = dist(gen);
+      s21_rhs.insert(value);
+      std_rhs.insert(value);
+    }
+    std::vector<int> expected;
+    std::set_union(std_lhs.begin(), std_lhs.end(), std_rhs.begin(),
+                   std_rhs.end(), std::back_inserter(expected));
+    s21::set<int> result = s21::set_union(s21_lhs, s21_rhs);
+    EXPECT_TRUE(result.is_balanced());
+    EXPECT_TRUE(containers_equal(result.begin(), result.end(),
+                                 expected.begin(), expected.end()));
+
+    expected.clear();
+    std::set_intersection(std_rhs.begin(), std_rhs.end(), std_lhs.begin(),
+                          std_lhs.end(), std::back_inserter(expected));
+    result = s21::set_intersection(s21_rhs, s21_lhs);
+    EXPECT_TRUE(result.is_balanced());
+    EXPECT_TRUE(containers_equal(result.begin(), result.end(),
+                                 expected.begin(), expected.end()));
+
+    expected.clear();
+    std::set_difference(std_lhs.begin(), std_lhs.end(), std_rhs.begin(),
+                        std_rhs.end(), std::back_inserter(expected));
+    result = s21::set_difference(s21_lhs, s21_rhs);
+    EXPECT_EQ(result.size(), expected.size());
+    EXPECT_TRUE(containers_equal(result.begin(), result.end(),
+                                 expected.begin(), expected.end()));
+
+    expected.clear();
+    std::set_symmetric_difference(std_lhs.begin(), std_lhs.end(),
+                                  std_rhs.begin(), std_rhs.end(),
+                                  std::back_inserter(expected));
+    result = s21::set_symmetric_difference(s21_lhs, s21_rhs);
+    EXPECT_TRUE(containers_equal(result.begin(), result.end(),
+                                 expected.begin(), expected.end()));
+  }
+  s21::set<int> s21_set = {1, 2, 3};
+  std::set<int> std_set = {1, 3};
+  s21_set.assign_difference(s21_set, s21::set<int>{2});
+  EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(),
+                               std_set.begin(), std_set.end()));
+}
+
+struct first_less {
+  bool operator()(const std::pair<int, int> &a,
+                  const std::pair<int, int> &b) const {
+    return a.first < b.first;
+  }
+};
+
+TEST(set_test, skewed_union_keeps_lhs_elements) {
+  using tagged_set = s21::set<std::pair<int, int>, first_less>;
+  tagged_set large;
+  tagged_set small = {{5, 1}, {500, 1}, {5000, 1}};
+  for (int i = 0; i < 3000; i += 5) large.insert({i, 0});
+  for (bool small_first : {true, false}) {
+    tagged_set result = small_first ? s21::set_union(small, large)
+                                    : s21::set_union(large, small);
+    EXPECT_TRUE(result.is_balanced());
+    EXPECT_EQ(result.size(), large.size() + 1);
+    int tag = small_first ? 1 : 0;
+    EXPECT_EQ(result.find({5, 0})->second, tag);
+    EXPECT_EQ(result.find({500, 0})->second, tag);
+    EXPECT_EQ(result.find({5000, 0})->second, 1);
+    EXPECT_EQ(result.find({10, 0})->second, 0);
+  }
+  large.assign_union(small, large);
+  EXPECT_EQ(large.size(), 601U);
+  EXPECT_EQ(large.find({500, 0})->second, 1);
+  EXPECT_EQ(large.back().first, 5000);
+}
+
+TEST(set_test, thread_pool_parallel_for) {
+  s21::thread_pool pool(3);
+  EXPECT_EQ(pool.concurrency(), 4U);
+  std::vector<int> hits(1000, 0);
+  pool.parallel_for(hits.size(), [&hits](size_t index) { ++hits[index]; });
+  for (int hit : hits) EXPECT_EQ(hit, 1);
+  EXPECT_THROW(pool.parallel_for(100,
+                                 [](size_t index) {
+                                   if (index == 42) throw std::logic_error("");
+                                 }),
+               std::logic_error);
+}
+
+TEST(set_test, thread_pool_nested_parallel_for) {
+  s21::thread_pool pool(3);
+  EXPECT_FALSE(s21::thread_pool::inside_task());
+  std::vector<std::atomic<int>> hits(64 * 64);
+  pool.parallel_for(64, [&pool, &hits](size_t outer) {
+    EXPECT_TRUE(s21::thread_pool::inside_task());
+    // вложенный цикл не ждет занятых рабочих, а идет на месте
+    pool.parallel_for(64, [&hits, outer](size_t inner) {
+      ++hits[outer * 64 + inner];
+    });
+  });
+  EXPECT_FALSE(s21::thread_pool::inside_task());
+  for (const std::atomic<int> &hit : hits) EXPECT_EQ(hit, 1);
+}
+
+struct front_less {
+  bool operator()(const s21::set<int> &lhs, const s21::set<int> &rhs) const {
+    return lhs.front() < rhs.front();
+  }
+};
+
+TEST(set_test_eq, parallel_copy_of_nested_sets) {
+  using nested_set = s21::set<s21::set<int>, front_less>;
+  nested_set lhs;
+  nested_set rhs;
+  // внешних элементов хватает на параллельный режим, а крупные внутренние
+  // множества копируются уже внутри задач пула
+  for (int i = 0; i < 10000; ++i) {
+    s21::set<int> inner = {i * 10};
+    if (i % 2500 == 0) {
+      for (int j = 1; j < 20000; ++j) inner.insert(i * 10 + j);
+    }
+    lhs.insert(inner);
+    rhs.insert(s21::set<int>{i * 10 + 5});
+  }
+  nested_set result = s21::set_union(lhs, rhs, s21::execution::parallel);
+  nested_set copy(result, s21::execution::parallel);
+  ASSERT_EQ(copy.size(), 20000U);
+  int index = 0;
+  for (const s21::set<int> &inner : copy) {
+    int front = index / 2 * 10 + index % 2 * 5;
+    bool large = index % 2 == 0 && index / 2 % 2500 == 0;
+    EXPECT_EQ(inner.front(), front);
+    EXPECT_EQ(inner.size(), large ? 20000U : 1U);
+    EXPECT_TRUE(inner.is_balanced());
+    ++index;
+  }
+}
+
+TEST(set_test_eq, parallel_set_algebra) {
+  using ranked_set =
+      s21::set<int, std::less<int>, s21::pool_allocator<int>,
+               s21::tree_options<true>>;
+  std::mt19937 gen(17);
+  std::uniform_int_distribution<int> dist(0, 199999);
+  std::set<int> std_lhs;
+  std::set<int> std_rhs;
+  for (int i = 0; i < 60000; ++i) {
+    std_lhs.insert(dist(gen));
+    std_rhs.insert(dist(gen));
+  }
+  ranked_set s21_lhs(std_lhs.begin(), std_lhs.end());
+  ranked_set s21_rhs(std_rhs.begin(), std_rhs.end());
+
+  std::vector<int> expected;
+  std::set_union(std_lhs.begin(), std_lhs.end(), std_rhs.begin(),
+                 std_rhs.end(), std::back_inserter(expected));
+  ranked_set result =
+      s21::set_union(s21_lhs, s21_rhs, s21::execution::parallel);
+  EXPECT_TRUE(result.is_balanced());
+  EXPECT_EQ(result.size(), expected.size());
+  EXPECT_TRUE(containers_equal(result.begin(), result.end(),
+                               expected.begin(), expected.end()));
+  EXPECT_EQ(*result.nth(expected.size() / 2), expected[expected.size() / 2]);
+
+  expected.clear();
+  std::set_intersection(std_lhs.begin(), std_lhs.end(), std_rhs.begin(),
+                        std_rhs.end(), std::back_inserter(expected));
+  result = s21::set_intersection(s21_lhs, s21_rhs, s21::execution::parallel);
+  EXPECT_TRUE(containers_equal(result.begin(), result.end(),
+                               expected.begin(), expected.end()));
+
+  expected.clear();
+  std::set_difference(std_lhs.begin(), std_lhs.end(), std_rhs.begin(),
+                      std_rhs.end(), std::back_inserter(expected));
+  result = s21::set_difference(s21_lhs, s21_rhs, s21::execution::parallel);
+  EXPECT_TRUE(result.is_balanced());
+  EXPECT_TRUE(containers_equal(result.begin(), result.end(),
+                               expected.begin(), expected.end()));
+
+  expected.clear();
+  std::set_symmetric_difference(std_lhs.begin(), std_lhs.end(),
+                                std_rhs.begin(), std_rhs.end(),
+                                std::back_inserter(expected));
+  result = s21::set_symmetric_difference(s21_lhs, s21_rhs,
+                                         s21::execution::parallel);
+  EXPECT_EQ(result.size(), expected.size());
+  EXPECT_TRUE(containers_equal(result.begin(), result.end(),
+                               expected.begin(), expected.end()));
+}
+
+TEST(set_test_eq, insert_sorted) {
+  for (auto policy : {s21::execution::sequential, s21::execution::parallel}) {
+    for (int batch_size : {10, 30000}) {
+      s21::set<int> s21_set;
+      std::set<int> std_set;
+      for (int i = 0; i < 40000; i += 2) {
+        s21_set.insert(i);
+        std_set.insert(i);
+      }
+      auto kept = s21_set.find(1000);
+      std::vector<int> batch;
+      for (int i = 0; i < batch_size; ++i) batch.push_back(i * 3 / 2);
+      s21_set.insert_sorted(batch.begin(), batch.end(), policy);
+      std_set.insert(batch.begin(), batch.end());
+      EXPECT_TRUE(s21_set.is_balanced());
+      EXPECT_EQ(s21_set.size(), std_set.size());
+      EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(),
+                                   std_set.begin(), std_set.end()));
+      EXPECT_EQ(*kept, 1000);
+      EXPECT_TRUE(s21_set.find(1000) == kept);
+    }
+  }
+  s21::set<int> s21_set = {5, 1};
+  std::vector<int> unsorted = {4, 2, 3};
+  s21_set.insert_sorted(unsorted.begin(), unsorted.end());
+  EXPECT_EQ(s21_set.size(), 5U);
+  EXPECT_EQ(s21_set.back(), 5);
+}
+
+struct throwing_copy {
+  static int copies_left;
+  int value;
+  explicit throwing_copy(int v) : value(v) {}
+  throwing_copy(const throwing_copy &other) : value(other.value) {
+    if (copies_left-- == 0) throw std::runtime_error("copy");
+  }
+  bool operator<(const throwing_copy &other) const {
+    return value < other.value;
+  }
+};
+int throwing_copy::copies_left = -1;
+
+TEST(set_test, copy_keeps_shape_and_colors) {
+  s21::set<int> s21_set;
+  std::set<int> std_set;
+  std::mt19937 gen(18);
+  for (int i = 0; i < 5000; ++i) {
+    int value = static_cast<int>(gen() % 20000);
+    s21_set.insert(value);
+    std_set.insert(value);
+  }
+  s21::set<int> copy(s21_set);
+  EXPECT_TRUE(copy.is_balanced());
+  for (int i = 0; i < 5000; ++i) {
+    int value = static_cast<int>(gen() % 20000);
+    copy.insert(value);
+    std_set.insert(value);
+    if (i % 3 == 0) {
+      copy.erase(value);
+      std_set.erase(value);
+    }
+  }
+  EXPECT_TRUE(copy.is_balanced());
+  EXPECT_TRUE(containers_equal(copy.begin(), copy.end(), std_set.begin(),
+                               std_set.end()));
+
+  using ranked_set =
+      s21::set<int, std::less<int>, s21::pool_allocator<int>,
+               s21::tree_options<true>>;
+  ranked_set ranked(std_set.begin(), std_set.end());
+  ranked_set ranked_copy(ranked);
+  ranked_copy.insert(-1);
+  EXPECT_EQ(*ranked_copy.nth(1), *ranked.nth(0));
+  EXPECT_EQ(ranked_copy.rank(*std_set.rbegin()), std_set.size());
+}
+
+// Отмечает копии, сделанные не в потоке теста
+struct thread_marked {
+  static std::thread::id owner;
+  static std::atomic<bool> foreign_copy;
+  int value = 0;
+  thread_marked() = default;
+  explicit thread_marked(int v) : value(v) {}
+  thread_marked(const thread_marked &other) : value(other.value) {
+    if (std::this_thread::get_id() != owner) foreign_copy = true;
+  }
+  bool operator<(const thread_marked &other) const {
+    return value < other.value;
+  }
+};
+std::thread::id thread_marked::owner;
+std::atomic<bool> thread_marked::foreign_copy{false};
+
+TEST(set_test, copy_is_parallel_only_on_request) {
+  s21::set<thread_marked> s21_set;
+  for (int i = 0; i < 40000; ++i) s21_set.emplace(i);
+  thread_marked::owner = std::this_thread::get_id();
+  thread_marked::foreign_copy = false;
+  s21::set<thread_marked> copy(s21_set);
+  EXPECT_FALSE(thread_marked::foreign_copy);
+  s21::set<thread_marked> parallel_copy(s21_set, s21::execution::parallel);
+  EXPECT_TRUE(copy.is_balanced());
+  EXPECT_TRUE(parallel_copy.is_balanced());
+  ASSERT_EQ(parallel_copy.size(), s21_set.size());
+  int expected = 0;
+  for (const thread_marked &item : parallel_copy) {
+    EXPECT_EQ(item.value, expected++);
+  }
+}
+
+TEST(set_test, copy_cleans_up_on_exception) {
+  s21::set<throwing_copy> s21_set;
+  for (int i = 0; i < 100; ++i) s21_set.emplace(i);
+  throwing_copy::copies_left = 60;
+  EXPECT_THROW(s21::set<throwing_copy> copy(s21_set), std::runtime_error);
+  throwing_copy::copies_left = -1;
+  s21::set<throwing_copy> copy(s21_set);
+  EXPECT_EQ(copy.size(), 100U);
+}
+
+template <size_t node_slots>
+using btree_set = s21::set<int, std::less<int>, s21::pool_allocator<int>,
+                           s21::btree_options<node_slots>>;
+
+template <size_t node_slots>
+void check_btree_set(unsigned seed) {
+  btree_set<node_slots> s21_set;
+  std::set<int> std_set;
+  std::mt19937 gen(seed);
+  for (int i = 0; i < 20000; ++i) {
+    int value = static_cast<int>(gen() % 3000);
+    switch (gen() % 4) {
+      case 0:
+      case 1: {
+        auto result = s21_set.insert(value);
+        EXPECT_EQ(result.second, std_set.insert(value).second);
+        EXPECT_EQ(*result.first, value);
+        break;
+      }
+      case 2:
+        EXPECT_EQ(s21_set.erase(value), std_set.erase(value));
+        break;
+      default: {
+        auto hint = s21_set.lower_bound(value);
+        auto std_hint = std_set.lower_bound(value);
+        EXPECT_EQ(hint == s21_set.end(), std_hint == std_set.end());
+        if (std_hint != std_set.end()) {
+          EXPECT_EQ(*hint, *std_hint);
+        }
+        EXPECT_EQ(*s21_set.emplace_hint(hint, value), value);
+        std_set.insert(value);
+      }
+    }
+  }
+  EXPECT_TRUE(s21_set.is_balanced());
+  EXPECT_EQ(s21_set.size(), std_set.size());
+  EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(),
+                               std_set.begin(), std_set.end()));
+  auto it = s21_set.end();
+  for (auto std_it = std_set.rbegin(); std_it != std_set.rend(); ++std_it) {
+    EXPECT_EQ(*--it, *std_it);
+  }
+  EXPECT_TRUE(it == s21_set.begin());
+
+  // удаление по итератору возвращает следующий элемент
+  for (auto pos = s21_set.begin(); pos != s21_set.end();) {
+    auto next = pos;
+    ++next;
+    bool last = next == s21_set.end();
+    int expected = last ? 0 : *next;
+    pos = s21_set.erase(pos, next);
+    if (last) {
+      EXPECT_TRUE(pos == s21_set.end());
+    } else {
+      EXPECT_EQ(*pos, expected);
+      ++pos;
+    }
+  }
+  EXPECT_TRUE(s21_set.is_balanced());
+}
+
+TEST(set_test_eq, btree_backend) {
+  static_assert(s21::tree_options<>::stable_iterators);
+  static_assert(!s21::btree_options<>::stable_iterators);
+  check_btree_set<3>(19);
+  check_btree_set<4>(20);
+  check_btree_set<0>(21);
+}
+
+TEST(set_test_eq, btree_bulk_operations) {
+  for (size_t count : {0, 1, 4, 5, 97, 2000}) {
+    std::vector<int> values(count);
+    for (size_t i = 0; i < count; ++i) values[i] = static_cast<int>(i * 2);
+    btree_set<4> s21_set(values.begin(), values.end());
+    EXPECT_TRUE(s21_set.is_balanced());
+    btree_set<4> copy(s21_set);
+    EXPECT_TRUE(copy.is_balanced());
+    EXPECT_TRUE(containers_equal(copy.begin(), copy.end(), values.begin(),
+                                 values.end()));
+  }
+
+  std::set<int> std_set;
+  for (int i = 0; i < 3000; i += 3) std_set.insert(i);
+  btree_set<0> lhs(std_set.begin(), std_set.end());
+  btree_set<0> rhs;
+  std::set<int> std_rhs;
+  for (int i = 0; i < 3000; i += 5) {
+    rhs.insert(i);
+    std_rhs.insert(i);
+  }
+  std::vector<int> expected;
+  std::set_symmetric_difference(std_set.begin(), std_set.end(),
+                                std_rhs.begin(), std_rhs.end(),
+                                std::back_inserter(expected));
+  btree_set<0> result = s21::set_symmetric_difference(lhs, rhs);
+  EXPECT_TRUE(result.is_balanced());
+  EXPECT_TRUE(containers_equal(result.begin(), result.end(),
+                               expected.begin(), expected.end()));
+
+  btree_set<0> upper = lhs.split(1500);
+  EXPECT_EQ(upper.front(), 1500);
+  EXPECT_EQ(lhs.back(), 1497);
+  EXPECT_THROW(lhs.join(1400, upper), std::invalid_argument);
+  lhs.join(upper);
+  EXPECT_TRUE(upper.empty());
+  EXPECT_TRUE(containers_equal(lhs.begin(), lhs.end(), std_set.begin(),
+                               std_set.end()));
+
+  std::vector<int> batch;
+  for (int i = 1; i < 3000; i += 3) batch.push_back(i);
+  lhs.insert_sorted(batch.begin(), batch.end());
+  std_set.insert(batch.begin(), batch.end());
+  lhs.merge(rhs);
+  std_set.insert(std_rhs.begin(), std_rhs.end());
+  auto pred = [](int value) { return value % 7 == 0; };
+  size_t removed = s21::erase_if(lhs, pred);
+  size_t expected_removed = 0;
+  for (auto it = std_set.begin(); it != std_set.end();) {
+    it = pred(*it) ? (++expected_removed, std_set.erase(it)) : std::next(it);
+  }
+  EXPECT_EQ(removed, expected_removed);
+  EXPECT_TRUE(lhs.is_balanced());
+  EXPECT_TRUE(containers_equal(lhs.begin(), lhs.end(), std_set.begin(),
+                               std_set.end()));
+
+  auto handle = lhs.extract(3);
+  EXPECT_EQ(handle.value(), 3);
+  handle.value() = -3;
+  EXPECT_TRUE(lhs.insert(std::move(handle)).inserted);
+  EXPECT_EQ(lhs.front(), -3);
+}
+
+TEST(set_test, btree_copy_cleans_up_on_exception) {
+  using throwing_set =
+      s21::set<throwing_copy, std::less<throwing_copy>,
+               s21::pool_allocator<throwing_copy>, s21::btree_options<4>>;
+  throwing_set s21_set;
+  for (int i = 0; i < 100; ++i) s21_set.emplace(i);
+  throwing_copy::copies_left = 60;
+  EXPECT_THROW(throwing_set copy(s21_set), std::runtime_error);
+  throwing_copy::copies_left = -1;
+  throwing_set copy(s21_set);
+  EXPECT_EQ(copy.size(), 100U);
+  EXPECT_TRUE(copy.is_balanced());
+}
+
+TEST(set_test_eq, prefetch_option) {
+  using prefetching_set = s21::set<int, std::less<int>,
+                                   s21::pool_allocator<int>,
+                                   s21::tree_options<false, true>>;
+  prefetching_set s21_set;
+  std::set<int> std_set;
+  std::mt19937 gen(23);
+  std::uniform_int_distribution<int> dist(0, 999);
+  for (int i = 0; i < 2000; ++i) {
+    int value = dist(gen);
+    if (i % 3 == 0) {
+      EXPECT_EQ(s21_set.erase(value), std_set.erase(value));
+    } else {
+      EXPECT_EQ(s21_set.insert(value).second, std_set.insert(value).second);
+    }
+    EXPECT_EQ(s21_set.find(value) != s21_set.end(),
+              std_set.find(value) != std_set.end());
+  }
+  EXPECT_TRUE(s21_set.is_balanced());
+  EXPECT_TRUE(containers_equal(s21_set.begin(), s21_set.end(),
+                               std_set.begin(), std_set.end()));
+}
+
+TEST(set_test_eq, find_many_in_input_order) {
+  std::vector<int> values;
+  for (int i = 0; i < 1000; ++i) values.push_back(i * 3);
+  s21::set<int> s21_set(values.begin(), values.end());
+  btree_set<4> s21_btree(values.begin(), values.end());
+  std::set<int> std_set(values.begin(), values.end());
+
+  std::mt19937 gen(24);
+  std::uniform_int_distribution<int> dist(-5, 3005);
+  std::vector<int> keys;
+  for (int i = 0; i < 300; ++i) keys.push_back(dist(gen));
+
+  std::vector<s21::set<int>::iterator> found;
+  auto out = s21_set.find_many(keys.begin(), keys.end(),
+                               std::back_inserter(found));
+  *out = s21_set.end();
+  ASSERT_EQ(found.size(), keys.size() + 1);
+  const btree_set<4> &const_btree = s21_btree;
+  std::vector<btree_set<4>::const_iterator> btree_found;
+  const_btree.find_many(keys.begin(), keys.end(),
+                        std::back_inserter(btree_found));
+  ASSERT_EQ(btree_found.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    bool present = std_set.count(keys[i]) != 0;
+    EXPECT_EQ(found[i] != s21_set.end(), present);
+    EXPECT_EQ(btree_found[i] != const_btree.cend(), present);
+    if (present) {
+      EXPECT_EQ(*found[i], keys[i]);
+      EXPECT_EQ(*btree_found[i], keys[i]);
+    }
+  }
+}
+
+TEST(set_test_eq, freeze_and_thaw) {
+  for (int size = 0; size <= 70; ++size) {
+    s21::set<int> s21_set;
+    std::set<int> std_set;
+    for (int i = 0; i < size; ++i) {
+      s21_set.insert(i * 2);
+      std_set.insert(i * 2);
+    }
+    s21::frozen_set<int, std::less<int>, s21::pool_allocator<int>,
+                    s21::tree_options<>>
+        frozen = s21_set.freeze();
+    ASSERT_EQ(frozen.size(), std_set.size());
+    EXPECT_TRUE(containers_equal(frozen.begin(), frozen.end(),
+                                 std_set.begin(), std_set.end()));
+    // место перед корнем (нижним адресом) выровнено на строку кэша
+    uintptr_t root = UINTPTR_MAX;
+    for (const int &value : frozen) {
+      root = std::min(root, reinterpret_cast<uintptr_t>(&value));
+    }
+    if (size > 0) {
+      EXPECT_EQ((root - sizeof(int)) % 64, 0U);
+    }
+    for (int key = -1; key <= size * 2; ++key) {
+      auto lower = std_set.lower_bound(key);
+      auto upper = std_set.upper_bound(key);
+      EXPECT_EQ(frozen.contains(key), std_set.count(key) != 0);
+      EXPECT_EQ(frozen.count(key), std_set.count(key));
+      EXPECT_EQ(frozen.lower_bound(key) == frozen.end(),
+                lower == std_set.end());
+      EXPECT_EQ(frozen.upper_bound(key) == frozen.end(),
+                upper == std_set.end());
+      if (lower != std_set.end()) {
+        EXPECT_EQ(*frozen.lower_bound(key), *lower);
+      }
+      if (upper != std_set.end()) {
+        EXPECT_EQ(*frozen.upper_bound(key), *upper);
+      }
+    }
+    s21::set<int> thawed = frozen.thaw();
+    thawed.insert(-3);
+    std_set.insert(-3);
+    EXPECT_TRUE(containers_equal(thawed.begin(), thawed.end(),
+                                 std_set.begin(), std_set.end()));
+    EXPECT_EQ(frozen.contains(-3), false);
+  }
+}
+
+TEST(set_test_eq, freeze_btree_backend) {
+  btree_set<4> s21_btree;
+  std::set<int> values;
+  for (int i = 0; i < 500; ++i) values.insert((i * 37) % 701);
+  for (int value : values) s21_btree.insert(value);
+  auto frozen = s21_btree.freeze();
+  EXPECT_TRUE(containers_equal(frozen.begin(), frozen.end(), values.begin(),
+                               values.end()));
+  EXPECT_EQ(*frozen.find(37), 37);
+  EXPECT_TRUE(frozen.find(702) == frozen.end());
+  auto range = frozen.equal_range(74);
+  EXPECT_EQ(*range.first, 74);
+  EXPECT_EQ(*range.second, *values.upper_bound(74));
+  btree_set<4> thawed = frozen.thaw();
+  EXPECT_EQ(thawed.size(), values.size());
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <iostream>
+#include <string>
 #include <vector>
 
 #include "../s21_lib/s21_vector.h"
@@ -602,4 +603,31 @@ TEST(VectorOperatorEvenTest, OperatorEvenMove) {
   ASSERT_EQ(vec2[0], 1);
   ASSERT_EQ(vec2[1], 2);
   ASSERT_EQ(vec2[2], 3);
-}
\ No newline at end of file
+}
+
+// Вставка и удаление не пишут в неинициализированную память
+TEST(VectorInsertEraseTest, NonTrivialElements) {
+  s21::vector<std::string> vec{"b", "d"};
+  vec.insert(vec.begin(), "a");
+  vec.insert(vec.begin() + 2, "c");
+  vec.insert(vec.end(), vec[0]);
+  vec.erase(vec.begin() + 1);
+
+  std::vector<std::string> expected{"a", "c", "d", "a"};
+  ASSERT_EQ(vec.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(vec[i], expected[i]);
+  }
+}
+
+// У копии емкость равна выделенной памяти
+TEST(VectorCopyTest, CopyThenPushBack) {
+  s21::vector<int> vec1;
+  vec1.reserve(10);
+  vec1.push_back(1);
+  s21::vector<int> vec2(vec1);
+  ASSERT_EQ(vec2.capacity(), vec2.size());
+  vec2.push_back(2);
+  ASSERT_EQ((int)vec2.size(), 2);
+  ASSERT_EQ(vec2[1], 2);
+}